@@ -0,0 +1,438 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+#pragma once
+
+// Helpers shared by the benchmark examples: argument parsing for size lists, latency percentiles,
+// text/csv/json reporting, thread pinning, CPU time and waiting for samples.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "zenoh.hxx"
+
+namespace bench {
+
+/// Parse a comma separated list of sizes, each optionally suffixed with K, M or G (powers of 1024),
+/// e.g. "8,64,1K,64K,1M".
+inline std::vector<size_t> parse_size_list(const char *str) {
+    std::vector<size_t> out;
+    std::string s(str);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t end = s.find(',', pos);
+        if (end == std::string::npos) end = s.size();
+        std::string item = s.substr(pos, end - pos);
+        if (!item.empty()) {
+            char *suffix = nullptr;
+            unsigned long long value = std::strtoull(item.c_str(), &suffix, 10);
+            switch (*suffix) {
+                case 'k':
+                case 'K':
+                    value <<= 10;
+                    break;
+                case 'm':
+                case 'M':
+                    value <<= 20;
+                    break;
+                case 'g':
+                case 'G':
+                    value <<= 30;
+                    break;
+                case '\0':
+                    break;
+                default:
+                    throw std::runtime_error("Invalid size: '" + item + "'");
+            }
+            out.push_back(static_cast<size_t>(value));
+        }
+        pos = end + 1;
+    }
+    if (out.empty()) {
+        throw std::runtime_error(std::string("Empty size list: '") + str + "'");
+    }
+    return out;
+}
+
+/// Pin the calling thread to the given CPU. Returns false if pinning failed or is not supported on this platform.
+inline bool pin_current_thread_to_cpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/// CPU time consumed so far by all the threads of the process, in seconds.
+inline double process_cpu_time() { return static_cast<double>(std::clock()) / CLOCKS_PER_SEC; }
+
+/// Latency distribution summary, all values in microseconds.
+struct LatencySummary {
+    size_t count = 0;
+    double min = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+    double mean = 0;
+};
+
+/// Nearest-rank percentile of already sorted samples.
+inline double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    if (rank == 0) rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+/// Summarize latency samples (in microseconds). The vector is sorted in place.
+inline LatencySummary summarize(std::vector<double> &samples) {
+    LatencySummary s;
+    s.count = samples.size();
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    s.min = samples.front();
+    s.p50 = percentile(samples, 50);
+    s.p90 = percentile(samples, 90);
+    s.p99 = percentile(samples, 99);
+    s.p999 = percentile(samples, 99.9);
+    s.max = samples.back();
+    double sum = 0;
+    for (double v : samples) sum += v;
+    s.mean = sum / static_cast<double>(samples.size());
+    return s;
+}
+
+enum class OutputFormat { Text, Csv, Json };
+
+inline OutputFormat parse_output_format(const char *str) {
+    if (strcmp(str, "text") == 0) return OutputFormat::Text;
+    if (strcmp(str, "csv") == 0) return OutputFormat::Csv;
+    if (strcmp(str, "json") == 0) return OutputFormat::Json;
+    throw std::runtime_error(std::string("Output format can only be 'text', 'csv' or 'json', got: '") + str + "'");
+}
+
+/// One result row: an ordered list of (column name, value) pairs.
+class Record {
+   public:
+    Record &add(const std::string &name, const std::string &value) {
+        _fields.emplace_back(name, Value{value, true});
+        return *this;
+    }
+
+    Record &add(const std::string &name, const char *value) { return add(name, std::string(value)); }
+
+    template <class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+    Record &add(const std::string &name, T value) {
+        std::ostringstream ss;
+        if constexpr (std::is_floating_point_v<T>) {
+            ss << std::fixed << std::setprecision(3);
+        }
+        ss << value;
+        _fields.emplace_back(name, Value{ss.str(), false});
+        return *this;
+    }
+
+    /// Add min/p50/p90/p99/p99.9/max/mean columns in microseconds, with names starting with `prefix`.
+    Record &add(const LatencySummary &s, const std::string &prefix = "") {
+        return add(prefix + "min_us", s.min)
+            .add(prefix + "p50_us", s.p50)
+            .add(prefix + "p90_us", s.p90)
+            .add(prefix + "p99_us", s.p99)
+            .add(prefix + "p99.9_us", s.p999)
+            .add(prefix + "max_us", s.max)
+            .add(prefix + "mean_us", s.mean);
+    }
+
+   private:
+    friend class Reporter;
+    struct Value {
+        std::string text;
+        bool quoted;
+    };
+    std::vector<std::pair<std::string, Value>> _fields;
+};
+
+/// Prints records to stdout as `key=value` text, csv (header emitted once) or json lines.
+/// Progress and diagnostics of the benchmarks should go to stderr, so that stdout stays machine readable.
+class Reporter {
+   public:
+    explicit Reporter(OutputFormat format) : _format(format) {}
+
+    void print(const Record &r) {
+        std::ostream &os = std::cout;
+        switch (_format) {
+            case OutputFormat::Text:
+                for (size_t i = 0; i < r._fields.size(); i++) {
+                    os << (i == 0 ? "" : "  ") << r._fields[i].first << "=" << r._fields[i].second.text;
+                }
+                break;
+            case OutputFormat::Csv:
+                if (!_header_printed) {
+                    for (size_t i = 0; i < r._fields.size(); i++) {
+                        os << (i == 0 ? "" : ",") << r._fields[i].first;
+                    }
+                    os << "\n";
+                    _header_printed = true;
+                }
+                for (size_t i = 0; i < r._fields.size(); i++) {
+                    os << (i == 0 ? "" : ",") << r._fields[i].second.text;
+                }
+                break;
+            case OutputFormat::Json:
+                os << "{";
+                for (size_t i = 0; i < r._fields.size(); i++) {
+                    const auto &v = r._fields[i].second;
+                    os << (i == 0 ? "" : ",") << "\"" << r._fields[i].first << "\":";
+                    if (v.quoted) {
+                        os << "\"" << v.text << "\"";
+                    } else {
+                        os << v.text;
+                    }
+                }
+                os << "}";
+                break;
+        }
+        os << std::endl;
+    }
+
+   private:
+    OutputFormat _format;
+    bool _header_printed = false;
+};
+
+#if defined(ZENOHCXX_ZENOHC)
+/// Config of a peer session that either listens on or connects to `endpoint`, with multicast scouting disabled, so
+/// that two sessions of the same process can be connected to each other without any router or network setup.
+inline zenoh::Config loopback_config(const std::string &endpoint, bool listen) {
+    zenoh::Config config = zenoh::Config::create_default();
+    config.insert_json5(Z_CONFIG_MODE_KEY, "'peer'");
+    config.insert_json5(listen ? Z_CONFIG_LISTEN_KEY : Z_CONFIG_CONNECT_KEY, "[\"" + endpoint + "\"]");
+    config.insert_json5("scouting/multicast/enabled", "false");
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    config.insert_json5("transport/shared_memory/enabled", "true");
+#endif
+    return config;
+}
+
+/// Wait until the two sessions see each other as peers. Returns false on timeout.
+inline bool wait_connected(const zenoh::Session &a, const zenoh::Session &b,
+                           std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!a.get_peers_z_id().empty() && !b.get_peers_z_id().empty()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+#endif
+
+/// Attachment carrying the sequence number of a ping, which the pong echoes back. Keeping it out of the payload
+/// lets the same payload, e.g. a SHM buffer, be published by every ping.
+inline zenoh::Bytes seq_attachment(uint64_t seq) {
+    std::vector<uint8_t> data(sizeof(seq));
+    std::memcpy(data.data(), &seq, sizeof(seq));
+    return zenoh::Bytes(std::move(data));
+}
+
+/// Sequence number carried by the attachment of a sample, see `seq_attachment`.
+inline std::optional<uint64_t> read_seq(const zenoh::Sample &sample) {
+    auto attachment = sample.get_attachment();
+    if (!attachment.has_value()) return std::nullopt;
+    uint64_t seq = 0;
+    auto reader = attachment->get().reader();
+    if (reader.read(reinterpret_cast<uint8_t *>(&seq), sizeof(seq)) != sizeof(seq)) return std::nullopt;
+    return seq;
+}
+
+#if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_SUBSCRIPTION == 1
+/// Counts the samples received on a key expression and lets a thread wait until the sample with a given sequence
+/// number, see `seq_attachment`, has arrived.
+///
+/// In callback mode the samples are counted by the subscriber callback and the waiting thread blocks on a condition
+/// variable. In busy-poll mode the samples are delivered to a FifoChannel that the waiting thread drains itself with
+/// `try_recv`, spinning on the CPU instead of sleeping; this removes the wakeup latency from the measurement.
+class SampleWaiter {
+   public:
+    SampleWaiter(const zenoh::Session &session, const zenoh::KeyExpr &key_expr, bool busy_poll) {
+        if (busy_poll) {
+            _channel_sub.emplace(session.declare_subscriber(key_expr, zenoh::channels::FifoChannel(256)));
+        } else {
+            _callback_sub.emplace(session.declare_subscriber(
+                key_expr,
+                [this](const zenoh::Sample &sample) {
+                    {
+                        std::lock_guard lock(_mutex);
+                        on_sample(sample);
+                    }
+                    _condvar.notify_one();
+                },
+                zenoh::closures::none));
+        }
+    }
+
+    SampleWaiter(const SampleWaiter &) = delete;
+    SampleWaiter &operator=(const SampleWaiter &) = delete;
+
+    /// Wait until the sample with sequence number `seq`, or a later one, was received. Returns false on timeout.
+    /// A lost sample only makes the wait for its own sequence number time out, and a sample arriving late after a
+    /// timeout is never mistaken for the reply to a later request.
+    bool wait_for_seq(uint64_t seq, std::chrono::microseconds timeout) {
+        if (_channel_sub.has_value()) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            const auto &handler = _channel_sub->handler();
+            while (_last_seq.load(std::memory_order_relaxed) < seq) {
+                if (!poll(handler, deadline)) return false;
+            }
+            return true;
+        }
+        std::unique_lock lock(_mutex);
+        return _condvar.wait_for(lock, timeout, [&] { return _last_seq.load(std::memory_order_acquire) >= seq; });
+    }
+
+    /// Number of samples received since creation.
+    uint64_t received() const { return _received.load(std::memory_order_acquire); }
+
+   private:
+    using ChannelHandler = zenoh::channels::FifoChannel::HandlerType<zenoh::Sample>;
+
+    void on_sample(const zenoh::Sample &sample) {
+        auto seq = read_seq(sample);
+        if (seq.has_value() && *seq > _last_seq.load(std::memory_order_relaxed)) {
+            _last_seq.store(*seq, std::memory_order_release);
+        }
+        _received.fetch_add(1, std::memory_order_release);
+    }
+
+    // Processes one sample of the channel, if any. Returns false once the deadline passed or the channel is closed.
+    bool poll(const ChannelHandler &handler, std::chrono::steady_clock::time_point deadline) {
+        auto res = handler.try_recv();
+        if (std::holds_alternative<zenoh::Sample>(res)) {
+            on_sample(std::get<zenoh::Sample>(res));
+            return true;
+        }
+        return std::get<zenoh::channels::RecvError>(res) != zenoh::channels::RecvError::Z_DISCONNECTED &&
+               std::chrono::steady_clock::now() <= deadline;
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condvar;
+    std::atomic<uint64_t> _received = 0;
+    // Highest sequence number received, sequence numbers start at 1.
+    std::atomic<uint64_t> _last_seq = 0;
+    std::optional<zenoh::Subscriber<void>> _callback_sub;
+    std::optional<zenoh::Subscriber<ChannelHandler>> _channel_sub;
+};
+
+/// Round trip times and number of lost round trips of a ping-pong run.
+struct PingPongResult {
+    std::vector<double> rtt_us;
+    size_t timeouts = 0;
+    // Pings not sent because `make_ping` returned no payload.
+    size_t skipped = 0;
+};
+
+/// Measure round trips between two sessions: `a` publishes the pings, whose payloads are returned by `make_ping`,
+/// and a pong declared on `b` publishes back the payload of every ping it receives. Pongs are matched with their
+/// ping by the sequence number carried in the attachment, see `seq_attachment`. `make_ping` may also return an
+/// optional payload, an empty one skips the ping, e.g. when a SHM allocation failed.
+///
+/// Since the publishers and subscribers are declared by the call, the first ping is repeated until a pong comes
+/// back, for up to `setup_timeout`, so that pings sent before the routes are established are not counted.
+template <class F>
+PingPongResult ping_pong(const zenoh::Session &a, const zenoh::Session &b, size_t warmup, size_t iterations,
+                         bool busy_poll, F &&make_ping, std::chrono::milliseconds timeout = std::chrono::seconds(1),
+                         std::chrono::milliseconds setup_timeout = std::chrono::seconds(5)) {
+    auto pong_pub = b.declare_publisher(zenoh::KeyExpr("bench/ping_pong/pong"));
+    auto pong_sub = b.declare_subscriber(
+        zenoh::KeyExpr("bench/ping_pong/ping"),
+        [&pong_pub](const zenoh::Sample &sample) {
+            zenoh::Publisher::PutOptions options;
+            auto attachment = sample.get_attachment();
+            if (attachment.has_value()) options.attachment = attachment->get().clone();
+            pong_pub.put(sample.get_payload().clone(), std::move(options));
+        },
+        zenoh::closures::none);
+    SampleWaiter pongs(a, zenoh::KeyExpr("bench/ping_pong/pong"), busy_poll);
+    auto ping_pub = a.declare_publisher(zenoh::KeyExpr("bench/ping_pong/ping"));
+    uint64_t sent = 0;
+    auto ping = [&]() {
+        zenoh::Publisher::PutOptions options;
+        options.attachment = seq_attachment(++sent);
+        return options;
+    };
+
+    PingPongResult result;
+    auto setup_deadline = std::chrono::steady_clock::now() + setup_timeout;
+    do {
+        auto options = ping();
+        auto payload = std::optional<zenoh::Bytes>(make_ping());
+        if (payload.has_value()) ping_pub.put(std::move(*payload), std::move(options));
+    } while (!pongs.wait_for_seq(sent, std::min(timeout, std::chrono::milliseconds(100))) &&
+             std::chrono::steady_clock::now() < setup_deadline);
+
+    result.rtt_us.reserve(iterations);
+    for (size_t i = 0; i < warmup; i++) {
+        auto payload = std::optional<zenoh::Bytes>(make_ping());
+        if (!payload.has_value()) continue;
+        ping_pub.put(std::move(*payload), ping());
+        pongs.wait_for_seq(sent, timeout);
+    }
+    for (size_t i = 0; i < iterations; i++) {
+        auto options = ping();
+        auto start = std::chrono::steady_clock::now();
+        auto payload = std::optional<zenoh::Bytes>(make_ping());
+        if (!payload.has_value()) {
+            result.skipped++;
+            continue;
+        }
+        ping_pub.put(std::move(*payload), std::move(options));
+        if (!pongs.wait_for_seq(sent, timeout)) {
+            result.timeouts++;
+            continue;
+        }
+        result.rtt_us.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return result;
+}
+#endif
+
+}  // namespace bench
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Measures the cost of creating, concatenating and joining key expressions, including failed creations reporting their
+// error through the `err` argument. That none of these calls allocates on the C++ heap is checked by
+// tests/universal/allocations.cxx.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+
+using Clock = std::chrono::steady_clock;
+
+int _main(int argc, char **argv) {
+    const char *iterations_str = "1000000";
+    const char *output_str = "text";
+    getargs(argc, argv, {}, {},
+            {{"-n", {"number of iterations of each case", &iterations_str}},
+             {"-o", {"output format (text | csv | json)", &output_str}}});
+    const size_t iterations = std::atoi(iterations_str);
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+
+    const std::string key = "demo/example/bench/keyexpr";
+    const std::string_view key_view = key;
+    const KeyExpr prefix("demo/example");
+    const KeyExpr suffix("bench/keyexpr");
+    const std::string_view invalid = "demo/example/**/**/invalid?";
+
+    std::vector<std::pair<std::string, std::function<void()>>> cases = {
+        {"keyexpr_from_c_str", [&]() { KeyExpr k(key.c_str()); }},
+        {"keyexpr_from_string", [&]() { KeyExpr k(key); }},
+        {"keyexpr_from_string_view", [&]() { KeyExpr k(key_view); }},
+        {"keyexpr_no_autocanonize", [&]() { KeyExpr k(key_view, false); }},
+        {"keyexpr_concat", [&]() { KeyExpr k = prefix.concat("/bench"); }},
+        {"keyexpr_join", [&]() { KeyExpr k = prefix.join(suffix); }},
+        {"keyexpr_invalid_with_err", [&]() {
+             ZResult err = Z_OK;
+             KeyExpr k(invalid, false, &err);
+         }},
+    };
+
+    for (const auto &[name, run] : cases) {
+        for (size_t i = 0; i < iterations / 10; i++) run();
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) run();
+        double elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        reporter.print(bench::Record()
+                           .add("case", name)
+                           .add("iterations", iterations)
+                           .add("ns_per_op", elapsed_ns / iterations));
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    }
+    return -1;
+}
@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Query side of the query/reply benchmark, to be run against z_queryable_thr. A number of worker threads each keep
+// one get in flight: a new query is sent as soon as the previous one completes. For every combination of concurrency,
+// replies per query and payload size the benchmark reports the completed queries per second and the percentiles of
+// the time to first reply and of the time to query completion.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+
+struct Measurements {
+    std::vector<double> first_reply_us;
+    std::vector<double> completion_us;
+    uint64_t replies = 0;
+    uint64_t failed = 0;
+};
+
+// State of the query currently in flight of a worker using the callback API.
+struct PendingQuery {
+    std::mutex mutex;
+    std::condition_variable condvar;
+    bool done = false;
+    uint64_t replies = 0;
+    Clock::time_point first_reply;
+};
+
+ConsolidationMode parse_consolidation(const char *str) {
+    if (strcmp(str, "auto") == 0) return ConsolidationMode::Z_CONSOLIDATION_MODE_AUTO;
+    if (strcmp(str, "none") == 0) return ConsolidationMode::Z_CONSOLIDATION_MODE_NONE;
+    if (strcmp(str, "monotonic") == 0) return ConsolidationMode::Z_CONSOLIDATION_MODE_MONOTONIC;
+    if (strcmp(str, "latest") == 0) return ConsolidationMode::Z_CONSOLIDATION_MODE_LATEST;
+    throw std::runtime_error(std::string("Consolidation can only be 'auto', 'none', 'monotonic' or 'latest', got: '") +
+                             str + "'");
+}
+
+int _main(int argc, char **argv) {
+    const char *concurrency_str = "1,8,64";
+    const char *replies_str = "1";
+    const char *payload_sizes_str = "8";
+    const char *consolidation_str = "none";
+    const char *mode_str = "both";
+    const char *duration_ms_str = "2000";
+    const char *warmup_ms_str = "500";
+    const char *timeout_ms_str = "1000";
+    const char *output_str = "text";
+    Config config = parse_args(
+        argc, argv, {}, {},
+        {{"--inflight", {"comma separated list of the number of gets in flight", &concurrency_str}},
+         {"-r", {"comma separated list of the number of replies per query", &replies_str}},
+         {"-s", {"comma separated list of reply payload sizes, K and M suffixes are accepted", &payload_sizes_str}},
+         {"--consolidation", {"consolidation mode (auto | none | monotonic | latest)", &consolidation_str}},
+         {"--reply", {"reply handling (callback | channel | both)", &mode_str}},
+         {"-d", {"measurement duration of each point, in ms", &duration_ms_str}},
+         {"-w", {"warmup duration of each point, in ms", &warmup_ms_str}},
+         {"-t", {"timeout of each query, in ms", &timeout_ms_str}},
+         {"-o", {"output format (text | csv | json)", &output_str}}});
+    std::vector<size_t> concurrencies = bench::parse_size_list(concurrency_str);
+    std::vector<size_t> reply_counts = bench::parse_size_list(replies_str);
+    std::vector<size_t> payload_sizes = bench::parse_size_list(payload_sizes_str);
+    ConsolidationMode consolidation = parse_consolidation(consolidation_str);
+    std::vector<std::string> modes;
+    if (strcmp(mode_str, "callback") == 0 || strcmp(mode_str, "both") == 0) modes.push_back("callback");
+    if (strcmp(mode_str, "channel") == 0 || strcmp(mode_str, "both") == 0) modes.push_back("channel");
+    if (modes.empty()) {
+        throw std::runtime_error("Reply handling can only be 'callback', 'channel' or 'both'");
+    }
+    const auto duration = 1ms * std::atoi(duration_ms_str);
+    const auto warmup = 1ms * std::atoi(warmup_ms_str);
+    const uint64_t timeout_ms = std::atoi(timeout_ms_str);
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+
+    std::cerr << "Opening session...\n";
+    auto session = Session::open(std::move(config));
+    const KeyExpr keyexpr("test/rpc/**");
+
+    for (const auto &mode : modes) {
+        for (size_t concurrency : concurrencies) {
+            for (size_t replies : reply_counts) {
+                for (size_t payload_size : payload_sizes) {
+                    const std::string parameters =
+                        "replies=" + std::to_string(replies) + ";size=" + std::to_string(payload_size);
+                    std::atomic<bool> measuring = false;
+                    std::atomic<bool> stop = false;
+                    std::vector<Measurements> measurements(concurrency);
+
+                    auto get_options = [&]() {
+                        auto opts = Session::GetOptions::create_default();
+                        opts.consolidation = QueryConsolidation(consolidation);
+                        opts.timeout_ms = timeout_ms;
+                        return opts;
+                    };
+
+                    // Record a completed query, unless it completed outside of the measurement window.
+                    auto record = [&](Measurements &m, Clock::time_point start, Clock::time_point first_reply,
+                                      uint64_t received) {
+                        if (!measuring.load(std::memory_order_relaxed) || stop.load(std::memory_order_relaxed)) {
+                            return;
+                        }
+                        if (received == 0) {
+                            m.failed++;
+                            return;
+                        }
+                        auto end = Clock::now();
+                        m.first_reply_us.push_back(
+                            std::chrono::duration<double, std::micro>(first_reply - start).count());
+                        m.completion_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+                        m.replies += received;
+                    };
+
+                    std::vector<std::thread> workers;
+                    for (size_t w = 0; w < concurrency; w++) {
+                        if (mode == "callback") {
+                            workers.emplace_back([&, w]() {
+                                Measurements &m = measurements[w];
+                                auto pending = std::make_shared<PendingQuery>();
+                                while (!stop.load(std::memory_order_relaxed)) {
+                                    pending->done = false;
+                                    pending->replies = 0;
+                                    auto start = Clock::now();
+                                    session.get(
+                                        keyexpr, parameters,
+                                        [pending](const Reply &reply) {
+                                            if (!reply.is_ok()) return;
+                                            std::lock_guard lock(pending->mutex);
+                                            if (pending->replies++ == 0) pending->first_reply = Clock::now();
+                                        },
+                                        [pending]() {
+                                            {
+                                                std::lock_guard lock(pending->mutex);
+                                                pending->done = true;
+                                            }
+                                            pending->condvar.notify_one();
+                                        },
+                                        get_options());
+                                    std::unique_lock lock(pending->mutex);
+                                    pending->condvar.wait(lock, [&] { return pending->done; });
+                                    record(m, start, pending->first_reply, pending->replies);
+                                }
+                            });
+                        } else {
+                            workers.emplace_back([&, w]() {
+                                Measurements &m = measurements[w];
+                                while (!stop.load(std::memory_order_relaxed)) {
+                                    auto start = Clock::now();
+                                    Clock::time_point first_reply;
+                                    uint64_t received = 0;
+                                    auto handler = session.get(keyexpr, parameters,
+                                                               channels::FifoChannel(std::max<size_t>(replies, 16)),
+                                                               get_options());
+                                    // The channel is disconnected once the query is complete.
+                                    for (auto res = handler.recv(); std::holds_alternative<Reply>(res);
+                                         res = handler.recv()) {
+                                        if (!std::get<Reply>(res).is_ok()) continue;
+                                        if (received++ == 0) first_reply = Clock::now();
+                                    }
+                                    record(m, start, first_reply, received);
+                                }
+                            });
+                        }
+                    }
+
+                    std::this_thread::sleep_for(warmup);
+                    measuring = true;
+                    auto time_start = Clock::now();
+                    std::this_thread::sleep_for(duration);
+                    stop = true;
+                    double elapsed_s = std::chrono::duration<double>(Clock::now() - time_start).count();
+                    for (auto &t : workers) t.join();
+
+                    Measurements all;
+                    for (auto &m : measurements) {
+                        all.first_reply_us.insert(all.first_reply_us.end(), m.first_reply_us.begin(),
+                                                  m.first_reply_us.end());
+                        all.completion_us.insert(all.completion_us.end(), m.completion_us.begin(),
+                                                 m.completion_us.end());
+                        all.replies += m.replies;
+                        all.failed += m.failed;
+                    }
+                    double queries = static_cast<double>(all.completion_us.size());
+                    reporter.print(bench::Record()
+                                       .add("reply", mode)
+                                       .add("consolidation", consolidation_str)
+                                       .add("concurrency", concurrency)
+                                       .add("replies", replies)
+                                       .add("size", payload_size)
+                                       .add("queries_per_s", queries / elapsed_s)
+                                       .add("replies_per_s", static_cast<double>(all.replies) / elapsed_s)
+                                       .add("failed", all.failed)
+                                       .add(bench::summarize(all.first_reply_us), "first_reply_")
+                                       .add(bench::summarize(all.completion_us), "completion_"));
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+#ifdef ZENOHCXX_ZENOHC
+        init_log_from_env_or("error");
+#endif
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    }
+}
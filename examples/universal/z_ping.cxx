@@ -13,66 +13,107 @@
 //
 
 #include <chrono>
-#include <condition_variable>
 #include <cstring>
 #include <iostream>
-#include <mutex>
 #include <numeric>
+#include <vector>
 
+#include "../bench.h"
 #include "../getargs.h"
 #include "zenoh.hxx"
 
 using namespace zenoh;
 
+// The pong echoes the attachment, so that every pong can be matched with its ping.
+Publisher::PutOptions ping_options(uint64_t seq) {
+    Publisher::PutOptions options;
+    options.attachment = bench::seq_attachment(seq);
+    return options;
+}
+
 int _main(int argc, char** argv) {
     using namespace std::literals;
-    std::mutex mutex;
-    std::condition_variable condvar;
     const char* number_of_pings_str = "100";
-    const char* payload_size_str = "8";
+    const char* payload_sizes_str = "8";
     const char* warmup_ms_str = "1000";
     const char* timeout_ms_str = "100";
+    const char* cpu_str = nullptr;
+    const char* output_str = "text";
+    const char* busy_poll = nullptr;
+    const char* verbose = nullptr;
     Config config = parse_args(
         argc, argv, {}, {},
-        {{"-n", {"number of pings to be attempted", &number_of_pings_str}},
-         {"-s", {"size of the payload embedded in the ping and repeated by the pong", &payload_size_str}},
-         {"-w", {"the warmup time in ms during which pings will be emitted but not measured", &warmup_ms_str}},
-         {"-t", {"timeout for any individual ping, in ms", &timeout_ms_str}}});
+        {{"-n", {"number of pings to be attempted for each payload size", &number_of_pings_str}},
+         {"-s",
+          {"comma separated list of payload sizes embedded in the ping and repeated by the pong, K and M suffixes are "
+           "accepted (e.g. 8,1K,64K)",
+           &payload_sizes_str}},
+         {"-w",
+          {"the warmup time in ms during which pings will be emitted but not measured, for each payload size",
+           &warmup_ms_str}},
+         {"-t", {"timeout for any individual ping, in ms", &timeout_ms_str}},
+         {"--cpu", {"CPU to pin the ping thread to", &cpu_str}},
+         {"--busy", {"busy-poll the pongs with try_recv instead of waiting for the callback", &busy_poll, true}},
+         {"-o", {"output format (text | csv | json)", &output_str}},
+         {"-v", {"print every ping", &verbose, true}}});
     unsigned int number_of_pings = std::atoi(number_of_pings_str);
-    unsigned int payload_size = std::atoi(payload_size_str);
+    std::vector<size_t> payload_sizes = bench::parse_size_list(payload_sizes_str);
     unsigned int warmup_ms = std::atoi(warmup_ms_str);
     unsigned int timeout_ms = std::atoi(timeout_ms_str);
+    bench::Reporter reporter(bench::parse_output_format(output_str));
 
-    std::cout << "Opening session...\n";
+    std::cerr << "Opening session...\n";
     auto session = Session::open(std::move(config));
 
-    auto sub = session.declare_subscriber(
-        KeyExpr("test/pong"), [&condvar](const Sample&) mutable { condvar.notify_one(); }, closures::none);
+    if (cpu_str != nullptr && !bench::pin_current_thread_to_cpu(std::atoi(cpu_str))) {
+        std::cerr << "Failed to pin the ping thread to CPU " << cpu_str << "\n";
+    }
+
+    bench::SampleWaiter pongs(session, KeyExpr("test/pong"), busy_poll != nullptr);
     auto pub = session.declare_publisher(KeyExpr("test/ping"));
-    std::vector<uint8_t> data(payload_size);
-    std::iota(data.begin(), data.end(), uint8_t{0});
-    Bytes payload = std::move(data);
+    const auto timeout = 1ms * timeout_ms;
+    uint64_t sent = 0;
 
-    std::unique_lock lock(mutex);
-    if (warmup_ms > 0) {
-        auto end = std::chrono::steady_clock::now() + (1ms * warmup_ms);
-        while (std::chrono::steady_clock::now() < end) {
-            pub.put(payload.clone());
-            condvar.wait_for(lock, 1s);
+    for (size_t payload_size : payload_sizes) {
+        std::vector<uint8_t> data(payload_size);
+        std::iota(data.begin(), data.end(), uint8_t{0});
+        Bytes payload = std::move(data);
+
+        if (warmup_ms > 0) {
+            auto end = std::chrono::steady_clock::now() + (1ms * warmup_ms);
+            while (std::chrono::steady_clock::now() < end) {
+                pub.put(payload.clone(), ping_options(++sent));
+                pongs.wait_for_seq(sent, timeout);
+            }
         }
-    }
-    for (unsigned int i = 0; i < number_of_pings; i++) {
-        auto start = std::chrono::steady_clock::now();
-        pub.put(payload.clone());
-        if (condvar.wait_for(lock, 1s) == std::cv_status::timeout) {
-            std::cout << "TIMEOUT seq=" << i << "\n";
-            continue;
+
+        std::vector<double> rtts;
+        rtts.reserve(number_of_pings);
+        unsigned int timeouts = 0;
+        for (unsigned int i = 0; i < number_of_pings; i++) {
+            auto options = ping_options(++sent);
+            auto start = std::chrono::steady_clock::now();
+            pub.put(payload.clone(), std::move(options));
+            if (!pongs.wait_for_seq(sent, timeout)) {
+                timeouts++;
+                if (verbose) std::cerr << "TIMEOUT seq=" << i << "\n";
+                continue;
+            }
+            double rtt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            rtts.push_back(rtt);
+            if (verbose) {
+                std::cerr << payload_size << " bytes: seq=" << i << " rtt=" << rtt << "µs" << " lat=" << rtt / 2
+                          << "µs\n";
+            }
         }
-        auto rtt =
-            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
-        std::cout << payload_size << " bytes: seq=" << i << " rtt=" << rtt << "µs" << " lat=" << rtt / 2 << "µs\n";
+
+        reporter.print(bench::Record()
+                           .add("size", payload_size)
+                           .add("mode", busy_poll ? "busy" : "callback")
+                           .add("pings", number_of_pings)
+                           .add("timeouts", timeouts)
+                           .add(bench::summarize(rtts), "rtt_"));
     }
-    lock.unlock();
     return 0;
 }
 
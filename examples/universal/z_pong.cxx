@@ -29,7 +29,13 @@ int _main(int argc, char **argv) {
     auto pub = session.declare_publisher(KeyExpr("test/pong"));
     session.declare_background_subscriber(
         KeyExpr("test/ping"),
-        [pub = std::move(pub)](const Sample &sample) mutable { pub.put(sample.get_payload().clone()); },
+        [pub = std::move(pub)](const Sample &sample) mutable {
+            // Echo the attachment as well, it carries the sequence number of the ping.
+            Publisher::PutOptions options;
+            auto attachment = sample.get_attachment();
+            if (attachment.has_value()) options.attachment = attachment->get().clone();
+            pub.put(sample.get_payload().clone(), std::move(options));
+        },
         closures::none);
     std::cout << "Pong ready, press any key to quit\n";
     std::getchar();
@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Throughput scaling benchmark: sweeps the number of publisher threads, the number of keys and the payload size,
+// and measures the rate at which samples are delivered to the subscribers, either processed in the subscriber callback
+// or drained from a FifoChannel by one thread per key.
+//
+// Unless `--single` is given, the publishers use a second session, opened from the same arguments. With zenoh-c, its
+// listen endpoints are cleared so that only the subscriber session binds the endpoints of the config; with zenoh-pico,
+// both sessions join the multicast group given with `-l` in peer mode.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+struct alignas(64) Counter {
+    std::atomic<uint64_t> messages = 0;
+    std::atomic<uint64_t> bytes = 0;
+
+    void add(size_t len) {
+        messages.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(len, std::memory_order_relaxed);
+    }
+};
+
+struct Totals {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+};
+
+Totals sum(const std::vector<std::unique_ptr<Counter>>& counters) {
+    Totals t;
+    for (const auto& c : counters) {
+        t.messages += c->messages.load(std::memory_order_relaxed);
+        t.bytes += c->bytes.load(std::memory_order_relaxed);
+    }
+    return t;
+}
+
+std::string key_name(size_t k) { return "test/thr_scaling/" + std::to_string(k); }
+
+// Keys published by thread `t`: when there are at least as many keys as threads they are spread over the threads,
+// otherwise several threads publish on the same key.
+std::vector<size_t> keys_of_thread(size_t t, size_t threads, size_t keys) {
+    std::vector<size_t> out;
+    if (keys >= threads) {
+        for (size_t k = t; k < keys; k += threads) out.push_back(k);
+    } else {
+        out.push_back(t % keys);
+    }
+    return out;
+}
+
+int _main(int argc, char** argv) {
+    const char* threads_str = "1,2,4,8";
+    const char* keys_str = "1,8";
+    const char* payload_sizes_str = "8,1K,64K";
+    const char* mode_str = "both";
+    const char* duration_ms_str = "2000";
+    const char* warmup_ms_str = "500";
+    const char* output_str = "text";
+    const char* single_session = nullptr;
+    const char* block = nullptr;
+    auto args = std::unordered_map<std::string, CmdArg>{
+        {"-p", {"comma separated list of publisher thread counts", &threads_str}},
+        {"-k", {"comma separated list of key counts", &keys_str}},
+        {"-s", {"comma separated list of payload sizes, K and M suffixes are accepted", &payload_sizes_str}},
+        {"--sub", {"subscriber path (callback | channel | both)", &mode_str}},
+        {"-d", {"measurement duration of each point, in ms", &duration_ms_str}},
+        {"-w", {"warmup duration of each point, in ms", &warmup_ms_str}},
+        {"-o", {"output format (text | csv | json)", &output_str}},
+        {"--single", {"publish and subscribe on the same session", &single_session, true}},
+        {"--block", {"use blocking congestion control instead of dropping", &block, true}}};
+    Config sub_config = parse_args(argc, argv, {}, {}, args);
+    std::vector<size_t> thread_counts = bench::parse_size_list(threads_str);
+    std::vector<size_t> key_counts = bench::parse_size_list(keys_str);
+    for (size_t keys : key_counts) {
+        if (keys == 0) throw std::runtime_error("Key counts must be positive");
+    }
+    std::vector<size_t> payload_sizes = bench::parse_size_list(payload_sizes_str);
+    std::vector<std::string> modes;
+    if (strcmp(mode_str, "callback") == 0 || strcmp(mode_str, "both") == 0) modes.push_back("callback");
+    if (strcmp(mode_str, "channel") == 0 || strcmp(mode_str, "both") == 0) modes.push_back("channel");
+    if (modes.empty()) {
+        throw std::runtime_error("Subscriber path can only be 'callback', 'channel' or 'both'");
+    }
+    for (size_t size : payload_sizes) {
+        if (size == 0) throw std::runtime_error("Payload size must be positive");
+    }
+    const auto duration = 1ms * std::atoi(duration_ms_str);
+    const auto warmup = 1ms * std::atoi(warmup_ms_str);
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+
+    std::cerr << "Opening session...\n";
+    auto sub_session = Session::open(std::move(sub_config));
+    std::optional<Session> pub_session_opt;
+    if (!single_session) {
+        Config pub_config = parse_args(argc, argv, {}, {}, args);
+#ifdef ZENOHCXX_ZENOHC
+        pub_config.insert_json5(Z_CONFIG_LISTEN_KEY, "[]");
+#endif
+        pub_session_opt.emplace(Session::open(std::move(pub_config)));
+    }
+    const Session& pub_session = single_session ? sub_session : *pub_session_opt;
+
+    for (const auto& mode : modes) {
+        for (size_t keys : key_counts) {
+            std::vector<std::unique_ptr<Counter>> counters;
+            std::vector<Subscriber<void>> callback_subs;
+            std::vector<std::thread> drain_threads;
+            std::atomic<size_t> drained = 0;
+            for (size_t k = 0; k < keys; k++) {
+                counters.push_back(std::make_unique<Counter>());
+                Counter* counter = counters.back().get();
+                if (mode == "callback") {
+                    callback_subs.push_back(sub_session.declare_subscriber(
+                        KeyExpr(key_name(k)),
+                        [counter](const Sample& sample) { counter->add(sample.get_payload().size()); },
+                        closures::none));
+                } else {
+                    auto sub = sub_session.declare_subscriber(KeyExpr(key_name(k)), channels::FifoChannel(1024));
+                    // An empty payload marks the end of the run, the thread exits once it received it.
+                    drain_threads.emplace_back([counter, &drained, sub = std::move(sub)]() {
+                        while (true) {
+                            auto res = sub.handler().recv();
+                            if (!std::holds_alternative<Sample>(res)) break;
+                            size_t len = std::get<Sample>(res).get_payload().size();
+                            if (len == 0) break;
+                            counter->add(len);
+                        }
+                        drained.fetch_add(1);
+                    });
+                }
+            }
+
+            for (size_t threads : thread_counts) {
+                for (size_t payload_size : payload_sizes) {
+                    std::atomic<bool> stop = false;
+                    std::vector<std::unique_ptr<Counter>> sent_counters;
+                    Bytes payload(std::vector<uint8_t>(payload_size, 0xa5));
+                    std::vector<std::thread> pub_threads;
+                    for (size_t t = 0; t < threads; t++) {
+                        sent_counters.push_back(std::make_unique<Counter>());
+                        Counter* sent = sent_counters.back().get();
+                        pub_threads.emplace_back([&, t, sent, payload = payload.clone()]() {
+                            std::vector<Publisher> pubs;
+                            for (size_t k : keys_of_thread(t, threads, keys)) {
+                                auto opts = Session::PublisherOptions::create_default();
+                                if (block) opts.congestion_control = CongestionControl::Z_CONGESTION_CONTROL_BLOCK;
+                                pubs.push_back(pub_session.declare_publisher(KeyExpr(key_name(k)), std::move(opts)));
+                            }
+                            for (size_t i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % pubs.size()) {
+                                pubs[i].put(payload.clone());
+                                sent->add(payload_size);
+                            }
+                        });
+                    }
+
+                    std::this_thread::sleep_for(warmup);
+                    Totals sent_start = sum(sent_counters);
+                    Totals received_start = sum(counters);
+                    double cpu_start = bench::process_cpu_time();
+                    auto time_start = std::chrono::steady_clock::now();
+                    std::this_thread::sleep_for(duration);
+                    Totals sent_end = sum(sent_counters);
+                    Totals received_end = sum(counters);
+                    double cpu_end = bench::process_cpu_time();
+                    double elapsed_s =
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+                    stop = true;
+                    for (auto& t : pub_threads) t.join();
+
+                    uint64_t sent = sent_end.messages - sent_start.messages;
+                    uint64_t received = received_end.messages - received_start.messages;
+                    double bits = static_cast<double>(received_end.bytes - received_start.bytes) * 8.0;
+                    double cpu_s = cpu_end - cpu_start;
+                    reporter.print(bench::Record()
+                                       .add("sub", mode)
+                                       .add("threads", threads)
+                                       .add("keys", keys)
+                                       .add("size", payload_size)
+                                       .add("msg_per_s", static_cast<double>(received) / elapsed_s)
+                                       .add("gbit_per_s", bits / elapsed_s / 1e9)
+                                       .add("sent_msg_per_s", static_cast<double>(sent) / elapsed_s)
+                                       .add("cpu_cores", cpu_s / elapsed_s)
+                                       .add("cpu_ns_per_msg", received > 0 ? cpu_s * 1e9 / received : 0.0));
+                }
+            }
+
+            if (mode == "channel") {
+                // Samples may be lost with best effort reliability, so keep sending the end marker until every
+                // drain thread has seen it.
+                std::vector<Publisher> marker_pubs;
+                for (size_t k = 0; k < keys; k++) {
+                    auto opts = Session::PublisherOptions::create_default();
+                    opts.congestion_control = CongestionControl::Z_CONGESTION_CONTROL_BLOCK;
+                    marker_pubs.push_back(pub_session.declare_publisher(KeyExpr(key_name(k)), std::move(opts)));
+                }
+                while (drained.load() < keys) {
+                    for (auto& p : marker_pubs) p.put(Bytes());
+                    std::this_thread::sleep_for(10ms);
+                }
+                for (auto& t : drain_threads) t.join();
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+#ifdef ZENOHCXX_ZENOHC
+        init_log_from_env_or("error");
+#endif
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    }
+}
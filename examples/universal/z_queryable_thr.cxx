@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Queryable side of the z_get_thr benchmark. Every query is answered with the number of replies and the payload size
+// requested in its parameters (`replies=<n>;size=<bytes>`), each reply on its own key `test/rpc/<i>`.
+
+#include <stdio.h>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+// Values which are not valid numbers fall back to the default: this runs in a Zenoh callback, which must not throw.
+size_t parameter(std::string_view parameters, std::string_view name, size_t default_value) {
+    size_t pos = 0;
+    while (pos < parameters.size()) {
+        size_t end = parameters.find(';', pos);
+        if (end == std::string_view::npos) end = parameters.size();
+        std::string_view item = parameters.substr(pos, end - pos);
+        if (item.size() > name.size() && item.substr(0, name.size()) == name && item[name.size()] == '=') {
+            std::string_view text = item.substr(name.size() + 1);
+            size_t value = 0;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc() && ptr == text.data() + text.size() ? value : default_value;
+        }
+        pos = end + 1;
+    }
+    return default_value;
+}
+
+int _main(int argc, char **argv) {
+    Config config = parse_args(argc, argv, {});
+
+    std::cout << "Opening session...\n";
+    auto session = Session::open(std::move(config));
+
+    std::atomic<uint64_t> queries = 0;
+    auto on_query = [&queries](const Query &query) {
+        // Payloads and reply key expressions are cached per thread, so that serving a query only costs reference
+        // count increments on the C++ side.
+        thread_local std::unordered_map<size_t, Bytes> payloads;
+        thread_local std::vector<KeyExpr> reply_keys;
+
+        auto params = query.get_parameters();
+        size_t replies = parameter(params, "replies", 1);
+        size_t size = parameter(params, "size", 8);
+        auto it = payloads.find(size);
+        if (it == payloads.end()) {
+            it = payloads.emplace(size, Bytes(std::vector<uint8_t>(size, 0xa5))).first;
+        }
+        while (reply_keys.size() < replies) {
+            reply_keys.emplace_back("test/rpc/" + std::to_string(reply_keys.size()));
+        }
+        for (size_t i = 0; i < replies; i++) {
+            query.reply(reply_keys[i], it->second.clone());
+        }
+        queries.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    auto queryable = session.declare_queryable(KeyExpr("test/rpc/**"), on_query, closures::none);
+
+    std::cout << "Press CTRL-C to quit...\n";
+    uint64_t last = 0;
+    while (true) {
+        std::this_thread::sleep_for(1s);
+        uint64_t current = queries.load(std::memory_order_relaxed);
+        if (current != last) {
+            std::cout << current - last << " queries/s\n";
+            last = current;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+#ifdef ZENOHCXX_ZENOHC
+        init_log_from_env_or("error");
+#endif
+        _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    }
+}
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Self contained benchmark harness: opens two peer sessions in the same process, one listening on a localhost
+// endpoint and the other connected to it (multicast scouting disabled, no router needed), and runs the pub/sub,
+// query/reply, shared memory and serialization scenarios back to back. Warmup is a fixed number of iterations, so that
+// successive runs on the same machine are comparable, and results are printed as json lines by default.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+
+struct Settings {
+    std::vector<size_t> payload_sizes;
+    size_t iterations;
+    size_t warmup;
+    size_t throughput_messages;
+    bool busy_poll;
+};
+
+Bytes make_payload(size_t size) {
+    std::vector<uint8_t> data(size);
+    std::iota(data.begin(), data.end(), uint8_t{0});
+    return Bytes(std::move(data));
+}
+
+double us_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+void report_ping_pong(const std::string &scenario, size_t size, const Settings &settings, bench::PingPongResult &&r,
+                      bench::Reporter &reporter) {
+    reporter.print(bench::Record()
+                       .add("scenario", scenario)
+                       .add("size", size)
+                       .add("iterations", settings.iterations)
+                       .add("timeouts", r.timeouts)
+                       .add(bench::summarize(r.rtt_us), "rtt_"));
+}
+
+void run_pubsub(const Session &a, const Session &b, const Settings &settings, bench::Reporter &reporter) {
+    for (size_t size : settings.payload_sizes) {
+        Bytes payload = make_payload(size);
+        report_ping_pong("pubsub_latency", size, settings,
+                         bench::ping_pong(a, b, settings.warmup, settings.iterations, settings.busy_poll,
+                                          [&payload]() { return payload.clone(); }),
+                         reporter);
+    }
+
+    for (size_t size : settings.payload_sizes) {
+        std::atomic<uint64_t> received = 0;
+        auto sub = b.declare_subscriber(
+            KeyExpr("bench/loopback/thr"),
+            [&received](const Sample &) { received.fetch_add(1, std::memory_order_relaxed); }, closures::none);
+        auto opts = Session::PublisherOptions::create_default();
+        opts.congestion_control = CongestionControl::Z_CONGESTION_CONTROL_BLOCK;
+#if defined(Z_FEATURE_UNSTABLE_API)
+        opts.reliability = Reliability::Z_RELIABILITY_RELIABLE;
+#endif
+        auto pub = a.declare_publisher(KeyExpr("bench/loopback/thr"), std::move(opts));
+        Bytes payload = make_payload(size);
+
+        auto send_and_wait = [&](size_t count) {
+            uint64_t target = received.load() + count;
+            for (size_t i = 0; i < count; i++) pub.put(payload.clone());
+            auto deadline = Clock::now() + 10s;
+            while (received.load() < target && Clock::now() < deadline) std::this_thread::sleep_for(100us);
+            return received.load() >= target;
+        };
+        send_and_wait(settings.warmup);
+        double cpu_start = bench::process_cpu_time();
+        auto start = Clock::now();
+        uint64_t received_start = received.load();
+        bool complete = send_and_wait(settings.throughput_messages);
+        double elapsed_s = us_since(start) / 1e6;
+        double cpu_s = bench::process_cpu_time() - cpu_start;
+        uint64_t count = received.load() - received_start;
+        reporter.print(bench::Record()
+                           .add("scenario", "pubsub_throughput")
+                           .add("size", size)
+                           .add("messages", count)
+                           .add("complete", complete ? "true" : "false")
+                           .add("msg_per_s", static_cast<double>(count) / elapsed_s)
+                           .add("gbit_per_s", static_cast<double>(count * size) * 8.0 / elapsed_s / 1e9)
+                           .add("cpu_ns_per_msg", count > 0 ? cpu_s * 1e9 / count : 0.0));
+    }
+}
+
+void run_get(const Session &a, const Session &b, const Settings &settings, bench::Reporter &reporter) {
+    for (size_t size : settings.payload_sizes) {
+        Bytes payload = make_payload(size);
+        KeyExpr keyexpr("bench/loopback/rpc");
+        auto queryable = b.declare_queryable(
+            keyexpr, [&payload, &keyexpr](const Query &query) { query.reply(keyexpr, payload.clone()); },
+            closures::none);
+
+        auto query = [&]() {
+            auto opts = Session::GetOptions::create_default();
+            opts.timeout_ms = 1000;
+            auto replies = a.get(keyexpr, "", channels::FifoChannel(16), std::move(opts));
+            size_t count = 0;
+            for (auto res = replies.recv(); std::holds_alternative<Reply>(res); res = replies.recv()) {
+                if (std::get<Reply>(res).is_ok()) count++;
+            }
+            return count > 0;
+        };
+        for (size_t i = 0; i < settings.warmup; i++) query();
+        std::vector<double> latencies;
+        latencies.reserve(settings.iterations);
+        size_t failed = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < settings.iterations; i++) {
+            auto query_start = Clock::now();
+            if (query()) {
+                latencies.push_back(us_since(query_start));
+            } else {
+                failed++;
+            }
+        }
+        double elapsed_s = us_since(start) / 1e6;
+        reporter.print(bench::Record()
+                           .add("scenario", "get_latency")
+                           .add("size", size)
+                           .add("iterations", settings.iterations)
+                           .add("failed", failed)
+                           .add("queries_per_s", static_cast<double>(latencies.size()) / elapsed_s)
+                           .add(bench::summarize(latencies), "completion_"));
+    }
+}
+
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+void run_shm(const Session &a, const Session &b, const Settings &settings, bench::Reporter &reporter) {
+    for (size_t size : settings.payload_sizes) {
+        PosixShmProvider provider(MemoryLayout(4 * size, AllocAlignment({2})));
+        auto alloc_result = provider.alloc_gc_defrag_blocking(size, AllocAlignment({0}));
+        ZShmMut &&buf_mut = std::get<ZShmMut>(std::move(alloc_result));
+        std::iota(buf_mut.data(), buf_mut.data() + size, uint8_t{0});
+        ZShm buf(std::move(buf_mut));
+        report_ping_pong("shm_latency", size, settings,
+                         bench::ping_pong(a, b, settings.warmup, settings.iterations, settings.busy_poll,
+                                          [&buf]() { return Bytes(ZShm(buf)); }),
+                         reporter);
+    }
+}
+#endif
+
+void run_serialization(const Settings &settings, bench::Reporter &reporter) {
+    for (size_t size : settings.payload_sizes) {
+        std::vector<double> value(std::max<size_t>(size / sizeof(double), 1));
+        std::iota(value.begin(), value.end(), 0.0);
+        std::vector<double> serialize_us, deserialize_us;
+        serialize_us.reserve(settings.iterations);
+        deserialize_us.reserve(settings.iterations);
+        for (size_t i = 0; i < settings.warmup + settings.iterations; i++) {
+            auto start = Clock::now();
+            Bytes bytes = ext::serialize(value);
+            double serialize_time = us_since(start);
+            start = Clock::now();
+            auto out = ext::deserialize<std::vector<double>>(bytes);
+            double deserialize_time = us_since(start);
+            if (out.size() != value.size()) throw std::runtime_error("Serialization roundtrip mismatch");
+            if (i >= settings.warmup) {
+                serialize_us.push_back(serialize_time);
+                deserialize_us.push_back(deserialize_time);
+            }
+        }
+        reporter.print(bench::Record()
+                           .add("scenario", "serialization")
+                           .add("type", "std::vector<double>")
+                           .add("size", value.size() * sizeof(double))
+                           .add("iterations", settings.iterations)
+                           .add(bench::summarize(serialize_us), "serialize_")
+                           .add(bench::summarize(deserialize_us), "deserialize_"));
+    }
+}
+
+int _main(int argc, char **argv) {
+    const char *endpoint = "tcp/127.0.0.1:7450";
+    const char *scenarios_str = "pubsub,get,shm,serialization";
+    const char *payload_sizes_str = "64,1K,64K";
+    const char *iterations_str = "10000";
+    const char *warmup_str = "1000";
+    const char *throughput_messages_str = "100000";
+    const char *output_str = "json";
+    const char *busy_poll = nullptr;
+    getargs(argc, argv, {}, {},
+            {{"-e", {"localhost endpoint the first session listens on and the second one connects to", &endpoint}},
+             {"--scenarios", {"comma separated list of scenarios (pubsub, get, shm, serialization)", &scenarios_str}},
+             {"-s", {"comma separated list of payload sizes, K and M suffixes are accepted", &payload_sizes_str}},
+             {"-n", {"number of measured iterations of latency scenarios", &iterations_str}},
+             {"-w", {"number of warmup iterations of every scenario", &warmup_str}},
+             {"--thr-messages", {"number of messages of the throughput scenario", &throughput_messages_str}},
+             {"--busy", {"busy-poll the pongs with try_recv instead of waiting for the callback", &busy_poll, true}},
+             {"-o", {"output format (text | csv | json)", &output_str}}});
+    Settings settings;
+    settings.payload_sizes = bench::parse_size_list(payload_sizes_str);
+    settings.iterations = std::atoi(iterations_str);
+    settings.warmup = std::atoi(warmup_str);
+    settings.throughput_messages = std::atoi(throughput_messages_str);
+    settings.busy_poll = busy_poll != nullptr;
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+    const std::string scenarios = std::string(",") + scenarios_str + ",";
+    auto enabled = [&scenarios](const char *name) {
+        return scenarios.find(std::string(",") + name + ",") != std::string::npos;
+    };
+
+    std::cerr << "Opening sessions on " << endpoint << "...\n";
+    auto a = Session::open(bench::loopback_config(endpoint, true));
+    auto b = Session::open(bench::loopback_config(endpoint, false));
+    if (!bench::wait_connected(a, b)) {
+        throw std::runtime_error("Sessions failed to connect to each other");
+    }
+
+    if (enabled("pubsub")) run_pubsub(a, b, settings, reporter);
+    if (enabled("get")) run_get(a, b, settings, reporter);
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    if (enabled("shm")) run_shm(a, b, settings, reporter);
+#else
+    if (enabled("shm")) std::cerr << "Skipping shm scenario: built without shared memory support\n";
+#endif
+    if (enabled("serialization")) run_serialization(settings, reporter);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+        init_log_from_env_or("error");
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    } catch (std::exception &e) {
+        std::cout << "Error :" << e.what() << "\n";
+    }
+    return -1;
+}
@@ -0,0 +1,313 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Compares the ways of building a payload across payload sizes:
+//   - copy: `Bytes(const std::vector<uint8_t>&)` copies a reused buffer,
+//   - move: `Bytes(std::vector<uint8_t>&&)` takes ownership of a freshly allocated buffer,
+//   - shm_<policy>: a buffer is allocated from a PosixShmProvider with the given `AllocLayout::alloc*` policy and
+//     published without copy.
+// Three groups of results are printed:
+//   - "produce": cost of producing a filled payload in the publishing thread,
+//   - "latency"/"throughput": round trip time and delivery rate between two sessions of this process connected over
+//     localhost (see z_bench_loopback),
+//   - "alloc": cost of every `ShmProvider::alloc*` policy and of the precomputed `AllocLayout::alloc`.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+
+double us_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+struct Settings {
+    size_t max_iterations;
+    size_t min_iterations;
+    size_t bytes_budget;
+    size_t shm_buffers;
+    bool busy_poll;
+
+    // Large payloads are measured on fewer iterations, so that every point moves about the same amount of data.
+    size_t iterations(size_t size) const {
+        return std::clamp<size_t>(bytes_budget / size, min_iterations, max_iterations);
+    }
+};
+
+// Produces filled payloads of a given size with one of the compared methods.
+class PayloadFactory {
+   public:
+    PayloadFactory(const std::string &method, size_t size, size_t shm_buffers) : _method(method), _size(size) {
+        if (method == "copy") {
+            _buffer.resize(size);
+        } else if (method != "move") {
+            _provider.emplace(MemoryLayout(shm_buffers * size, AllocAlignment({2})));
+            _layout.emplace(*_provider, size, AllocAlignment({0}));
+        }
+    }
+
+    /// Returns an empty optional if the SHM allocation failed.
+    std::optional<Bytes> make() {
+        if (_method == "copy") {
+            fill(_buffer.data());
+            return Bytes(_buffer);
+        } else if (_method == "move") {
+            std::vector<uint8_t> buffer(_size);
+            fill(buffer.data());
+            return Bytes(std::move(buffer));
+        }
+        BufAllocResult res = _method == "shm_alloc"      ? _layout->alloc()
+                             : _method == "shm_alloc_gc" ? _layout->alloc_gc()
+                                                         : _layout->alloc_gc_defrag_blocking();
+        if (!std::holds_alternative<ZShmMut>(res)) {
+            _failures++;
+            return {};
+        }
+        ZShmMut &buf = std::get<ZShmMut>(res);
+        fill(buf.data());
+        return Bytes(std::move(buf));
+    }
+
+    size_t failures() const { return _failures; }
+
+   private:
+    void fill(uint8_t *data) { memset(data, static_cast<int>(_counter++), _size); }
+
+    std::string _method;
+    size_t _size;
+    size_t _failures = 0;
+    uint8_t _counter = 0;
+    std::vector<uint8_t> _buffer;
+    std::optional<PosixShmProvider> _provider;
+    std::optional<AllocLayout> _layout;
+};
+
+const std::vector<std::string> methods = {"copy", "move", "shm_alloc", "shm_alloc_gc", "shm_alloc_gc_defrag_blocking"};
+
+void run_produce(const std::vector<size_t> &sizes, const Settings &settings, bench::Reporter &reporter) {
+    for (size_t size : sizes) {
+        size_t iterations = settings.iterations(size);
+        for (const auto &method : methods) {
+            PayloadFactory factory(method, size, settings.shm_buffers);
+            std::vector<double> times;
+            times.reserve(iterations);
+            for (size_t i = 0; i < iterations; i++) {
+                auto start = Clock::now();
+                auto payload = factory.make();
+                times.push_back(us_since(start));
+            }
+            double total_us = 0;
+            for (double t : times) total_us += t;
+            reporter.print(bench::Record()
+                               .add("group", "produce")
+                               .add("method", method)
+                               .add("size", size)
+                               .add("iterations", iterations)
+                               .add("alloc_failures", factory.failures())
+                               .add("gbyte_per_s", total_us > 0 ? size * iterations / total_us / 1e3 : 0.0)
+                               .add(bench::summarize(times)));
+        }
+    }
+}
+
+void run_transfer(const Session &a, const Session &b, const std::vector<size_t> &sizes, const Settings &settings,
+                  bench::Reporter &reporter) {
+    for (size_t size : sizes) {
+        size_t iterations = settings.iterations(size);
+        for (const auto &method : methods) {
+            PayloadFactory factory(method, size, settings.shm_buffers);
+            // Pings whose SHM allocation failed are skipped rather than measured as empty payloads.
+            auto pp = bench::ping_pong(a, b, std::max<size_t>(iterations / 10, 1), iterations, settings.busy_poll,
+                                       [&factory]() { return factory.make(); });
+            reporter.print(bench::Record()
+                               .add("group", "latency")
+                               .add("method", method)
+                               .add("size", size)
+                               .add("iterations", iterations)
+                               .add("timeouts", pp.timeouts)
+                               .add("skipped", pp.skipped)
+                               .add("alloc_failures", factory.failures())
+                               .add(bench::summarize(pp.rtt_us), "rtt_"));
+        }
+
+        for (const auto &method : methods) {
+            PayloadFactory factory(method, size, settings.shm_buffers);
+            std::atomic<uint64_t> received = 0;
+            std::atomic<uint64_t> checksum = 0;
+            auto sub = b.declare_subscriber(
+                KeyExpr("bench/payload/thr"),
+                [&received, &checksum](const Sample &sample) {
+                    // Touch the payload, as a real consumer would.
+                    auto it = sample.get_payload().slice_iter();
+                    for (auto slice = it.next(); slice.has_value(); slice = it.next()) {
+                        if (slice->len > 0) checksum.fetch_add(slice->data[0], std::memory_order_relaxed);
+                    }
+                    received.fetch_add(1, std::memory_order_relaxed);
+                },
+                closures::none);
+            auto opts = Session::PublisherOptions::create_default();
+            opts.congestion_control = CongestionControl::Z_CONGESTION_CONTROL_BLOCK;
+            opts.reliability = Reliability::Z_RELIABILITY_RELIABLE;
+            auto pub = a.declare_publisher(KeyExpr("bench/payload/thr"), std::move(opts));
+
+            auto send_and_wait = [&](size_t count) {
+                uint64_t target = received.load() + count;
+                for (size_t i = 0; i < count; i++) {
+                    auto payload = factory.make();
+                    if (payload.has_value()) {
+                        pub.put(std::move(*payload));
+                    } else {
+                        target--;
+                    }
+                }
+                auto deadline = Clock::now() + 30s;
+                while (received.load() < target && Clock::now() < deadline) std::this_thread::sleep_for(100us);
+                return received.load();
+            };
+            send_and_wait(std::max<size_t>(iterations / 10, 1));
+            uint64_t received_start = received.load();
+            double cpu_start = bench::process_cpu_time();
+            auto start = Clock::now();
+            uint64_t count = send_and_wait(iterations) - received_start;
+            double elapsed_s = us_since(start) / 1e6;
+            double cpu_s = bench::process_cpu_time() - cpu_start;
+            reporter.print(bench::Record()
+                               .add("group", "throughput")
+                               .add("method", method)
+                               .add("size", size)
+                               .add("messages", count)
+                               .add("alloc_failures", factory.failures())
+                               .add("msg_per_s", static_cast<double>(count) / elapsed_s)
+                               .add("gbit_per_s", static_cast<double>(count * size) * 8.0 / elapsed_s / 1e9)
+                               .add("cpu_us_per_msg", count > 0 ? cpu_s * 1e6 / count : 0.0));
+        }
+    }
+}
+
+void run_alloc(const std::vector<size_t> &sizes, const Settings &settings, bench::Reporter &reporter) {
+    const AllocAlignment alignment = {0};
+    for (size_t size : sizes) {
+        size_t iterations = settings.iterations(size);
+        PosixShmProvider provider(MemoryLayout(settings.shm_buffers * size, AllocAlignment({2})));
+        AllocLayout layout(provider, size, alignment);
+        const std::vector<std::pair<std::string, std::function<bool()>>> policies = {
+            {"provider_alloc", [&]() { return provider.alloc(size, alignment).index() == 0; }},
+            {"provider_alloc_gc", [&]() { return provider.alloc_gc(size, alignment).index() == 0; }},
+            {"provider_alloc_gc_defrag", [&]() { return provider.alloc_gc_defrag(size, alignment).index() == 0; }},
+            {"provider_alloc_gc_defrag_dealloc",
+             [&]() { return provider.alloc_gc_defrag_dealloc(size, alignment).index() == 0; }},
+            {"provider_alloc_gc_defrag_blocking",
+             [&]() { return provider.alloc_gc_defrag_blocking(size, alignment).index() == 0; }},
+            {"layout_alloc", [&]() { return layout.alloc().index() == 0; }},
+            {"layout_alloc_gc", [&]() { return layout.alloc_gc().index() == 0; }},
+            {"layout_alloc_gc_defrag_blocking", [&]() { return layout.alloc_gc_defrag_blocking().index() == 0; }},
+        };
+        for (const auto &[policy, alloc] : policies) {
+            // Every iteration allocates a buffer and drops it right away: policies that do not collect garbage
+            // start failing once the provider is exhausted, which shows in alloc_failures.
+            provider.garbage_collect();
+            std::vector<double> times;
+            times.reserve(iterations);
+            size_t failures = 0;
+            for (size_t i = 0; i < iterations; i++) {
+                auto start = Clock::now();
+                bool ok = alloc();
+                times.push_back(us_since(start));
+                if (!ok) failures++;
+            }
+            reporter.print(bench::Record()
+                               .add("group", "alloc")
+                               .add("method", policy)
+                               .add("size", size)
+                               .add("iterations", iterations)
+                               .add("alloc_failures", failures)
+                               .add(bench::summarize(times)));
+        }
+    }
+}
+
+int _main(int argc, char **argv) {
+    const char *endpoint = "tcp/127.0.0.1:7451";
+    const char *groups_str = "produce,transfer,alloc";
+    const char *payload_sizes_str = "64,1K,16K,256K,4M,64M";
+    const char *max_iterations_str = "10000";
+    const char *min_iterations_str = "20";
+    const char *bytes_budget_str = "256M";
+    const char *shm_buffers_str = "8";
+    const char *output_str = "text";
+    const char *busy_poll = nullptr;
+    getargs(argc, argv, {}, {},
+            {{"-e", {"localhost endpoint the first session listens on and the second one connects to", &endpoint}},
+             {"--groups", {"comma separated list of benchmark groups (produce, transfer, alloc)", &groups_str}},
+             {"-s", {"comma separated list of payload sizes, K and M suffixes are accepted", &payload_sizes_str}},
+             {"-n", {"maximum number of iterations of each point", &max_iterations_str}},
+             {"--min-iterations", {"minimum number of iterations of each point", &min_iterations_str}},
+             {"--budget", {"bytes moved by each point, bounds the iterations of large payloads", &bytes_budget_str}},
+             {"-b", {"SHM provider capacity, in number of payloads", &shm_buffers_str}},
+             {"--busy", {"busy-poll the pongs with try_recv instead of waiting for the callback", &busy_poll, true}},
+             {"-o", {"output format (text | csv | json)", &output_str}}});
+    std::vector<size_t> sizes = bench::parse_size_list(payload_sizes_str);
+    Settings settings;
+    settings.max_iterations = std::atoi(max_iterations_str);
+    settings.min_iterations = std::atoi(min_iterations_str);
+    settings.bytes_budget = bench::parse_size_list(bytes_budget_str).front();
+    settings.shm_buffers = std::atoi(shm_buffers_str);
+    settings.busy_poll = busy_poll != nullptr;
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+    const std::string groups = std::string(",") + groups_str + ",";
+    auto enabled = [&groups](const char *name) {
+        return groups.find(std::string(",") + name + ",") != std::string::npos;
+    };
+
+    if (enabled("produce")) run_produce(sizes, settings, reporter);
+    if (enabled("transfer")) {
+        std::cerr << "Opening sessions on " << endpoint << "...\n";
+        auto a = Session::open(bench::loopback_config(endpoint, true));
+        auto b = Session::open(bench::loopback_config(endpoint, false));
+        if (!bench::wait_connected(a, b)) {
+            throw std::runtime_error("Sessions failed to connect to each other");
+        }
+        run_transfer(a, b, sizes, settings, reporter);
+    }
+    if (enabled("alloc")) run_alloc(sizes, settings, reporter);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+        init_log_from_env_or("error");
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    } catch (std::exception &e) {
+        std::cout << "Error :" << e.what() << "\n";
+    }
+    return -1;
+}
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Compares the SHM provider backends on fixed size messages:
+//   - posix: PosixShmProvider,
+//   - slab: CppShmProvider over SlabShmProviderBackend, with a single size class,
+//   - slab_threadsafe: CppShmProvider over SlabShmProviderBackendThreadsafe,
+//   - tlsf: CppShmProvider over TlsfShmProviderBackend,
+//   - tlsf_threadsafe: CppShmProvider over TlsfShmProviderBackendThreadsafe.
+// Every round allocates `-b` buffers with `AllocLayout::alloc`, drops them and garbage collects them, the time per
+// allocation and per collected buffer is reported. With `-t` threads, the threads share the provider and the
+// non-threadsafe slab and tlsf backends are skipped. With `--stats`, some of the statistics of the providers
+// (occupancy, failures, collection time and upper bounds of the allocation latency percentiles) are added to the
+// report; the allocations and collections then go through stats collectors, which adds the cost of two clock reads to
+// every allocation.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "../bench.h"
+#include "../getargs.h"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double alloc_ns = 0;
+    double gc_ns = 0;
+    size_t failures = 0;
+};
+
+// With a collector, the allocations and collections go through it so that they are recorded.
+Result run_rounds(const ShmProvider &provider, const ShmProviderStatsCollector *stats, size_t size, size_t buffers,
+                  size_t rounds) {
+    AllocLayout layout(provider, size, AllocAlignment({0}));
+    std::optional<AllocLayoutStatsCollector> layout_stats;
+    if (stats != nullptr) layout_stats.emplace(layout, stats);
+    std::vector<ZShmMut> held;
+    held.reserve(buffers);
+    Result r;
+    for (size_t round = 0; round < rounds; round++) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < buffers; i++) {
+            BufAllocResult res = layout_stats.has_value() ? layout_stats->alloc() : layout.alloc();
+            if (std::holds_alternative<ZShmMut>(res)) {
+                held.push_back(std::get<ZShmMut>(std::move(res)));
+            } else {
+                r.failures++;
+            }
+        }
+        r.alloc_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        start = Clock::now();
+        held.clear();
+        if (stats != nullptr) {
+            stats->garbage_collect();
+        } else {
+            provider.garbage_collect();
+        }
+        r.gc_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+    r.alloc_ns /= static_cast<double>(rounds * buffers);
+    r.gc_ns /= static_cast<double>(rounds * buffers);
+    return r;
+}
+
+// The providers only differ by their construction, they are all handled as a ShmProvider. The options tell a stats
+// collector how to get the occupancy of the provider.
+struct Provider {
+    ShmProvider provider;
+    ShmProviderStatsCollector::ShmProviderStatsCollectorOptions stats_options;
+};
+
+Provider make_provider(const std::string &backend, size_t size, size_t capacity) {
+    const std::vector<SlabSizeClass> classes = {{size, capacity}};
+    auto cpp_provider = [](ProtocolId id, auto backend) {
+        const CppShmProviderBackendIface *iface = backend.get();
+        Provider p{CppShmProvider(id, std::move(backend)), {}};
+        p.stats_options.backend = iface;
+        return p;
+    };
+    if (backend == "posix") {
+        const size_t total = capacity * size;
+        Provider p{PosixShmProvider(MemoryLayout(total, AllocAlignment({6}))), {}};
+        p.stats_options.total = total;
+        return p;
+    } else if (backend == "slab") {
+        return cpp_provider(
+            100600, std::unique_ptr<CppShmProviderBackend>(std::make_unique<SlabShmProviderBackend>(classes)));
+    } else if (backend == "slab_threadsafe") {
+        return cpp_provider(100601, std::unique_ptr<CppShmProviderBackendThreadsafe>(
+                                        std::make_unique<SlabShmProviderBackendThreadsafe>(classes)));
+    }
+    // Every TLSF block has a 64 bytes header and its size is rounded up to 64 bytes.
+    const size_t tlsf_size = ((size + 63) / 64 + 1) * 64 * capacity;
+    if (backend == "tlsf") {
+        return cpp_provider(
+            100602, std::unique_ptr<CppShmProviderBackend>(std::make_unique<TlsfShmProviderBackend>(tlsf_size)));
+    } else if (backend == "tlsf_threadsafe") {
+        return cpp_provider(100603, std::unique_ptr<CppShmProviderBackendThreadsafe>(
+                                        std::make_unique<TlsfShmProviderBackendThreadsafe>(tlsf_size)));
+    }
+    throw std::runtime_error("Unknown backend: " + backend);
+}
+
+int _main(int argc, char **argv) {
+    const char *payload_sizes_str = "1K,4K,16K,64K,256K,1M";
+    const char *buffers_str = "64";
+    const char *rounds_str = "1000";
+    const char *threads_str = "1";
+    const char *output_str = "text";
+    const char *stats = nullptr;
+    getargs(argc, argv, {}, {},
+            {{"-s", {"comma separated list of message sizes, K and M suffixes are accepted", &payload_sizes_str}},
+             {"-b", {"number of buffers allocated by each thread in a round", &buffers_str}},
+             {"-n", {"number of rounds", &rounds_str}},
+             {"-t", {"number of allocating threads", &threads_str}},
+             {"-o", {"output format (text | csv | json)", &output_str}},
+             {"--stats", {"report the statistics of the providers", &stats, true}}});
+    const std::vector<size_t> sizes = bench::parse_size_list(payload_sizes_str);
+    const size_t buffers = std::atoi(buffers_str);
+    const size_t rounds = std::atoi(rounds_str);
+    const size_t threads = std::atoi(threads_str);
+    bench::Reporter reporter(bench::parse_output_format(output_str));
+
+    for (size_t size : sizes) {
+        for (const std::string backend : {"posix", "slab", "slab_threadsafe", "tlsf", "tlsf_threadsafe"}) {
+            if ((backend == "slab" || backend == "tlsf") && threads > 1) continue;
+            Provider p = make_provider(backend, size, buffers * threads);
+            std::optional<ShmProviderStatsCollector> collector;
+            if (stats != nullptr) collector.emplace(p.provider, std::move(p.stats_options));
+            const ShmProviderStatsCollector *c = collector.has_value() ? &*collector : nullptr;
+            std::vector<Result> results(threads);
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() { results[t] = run_rounds(p.provider, c, size, buffers, rounds); });
+            }
+            for (auto &w : workers) w.join();
+            Result total;
+            for (const auto &r : results) {
+                total.alloc_ns += r.alloc_ns / threads;
+                total.gc_ns += r.gc_ns / threads;
+                total.failures += r.failures;
+            }
+            auto record = bench::Record()
+                              .add("backend", backend)
+                              .add("size", size)
+                              .add("threads", threads)
+                              .add("alloc_ns", total.alloc_ns)
+                              .add("gc_ns_per_buffer", total.gc_ns)
+                              .add("alloc_failures", total.failures);
+            if (stats != nullptr) {
+                // Unknown occupancy is reported as 0, to keep the same columns for all backends.
+                const ShmProviderStats s = collector->stats();
+                record.add("total_bytes", s.total.value_or(0))
+                    .add("largest_free_bytes", s.largest_free.value_or(0))
+                    .add("failed_out_of_memory", s.failed_out_of_memory)
+                    .add("gc_ns", static_cast<uint64_t>(s.gc_time.count()))
+                    .add("alloc_p50_ns_max", static_cast<uint64_t>(s.alloc_latency.percentile(50).count()))
+                    .add("alloc_p99_ns_max", static_cast<uint64_t>(s.alloc_latency.percentile(99).count()));
+            }
+            reporter.print(record);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    try {
+        init_log_from_env_or("error");
+        return _main(argc, argv);
+    } catch (ZException e) {
+        std::cout << "Received an error :" << e.what() << "\n";
+    } catch (std::exception &e) {
+        std::cout << "Error :" << e.what() << "\n";
+    }
+    return -1;
+}
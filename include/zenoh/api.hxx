@@ -19,6 +19,7 @@
 #include "api/config.hxx"
 #include "api/encoding.hxx"
 #include "api/enums.hxx"
+#include "api/expected.hxx"
 #include "api/hello.hxx"
 #include "api/id.hxx"
 #include "api/keyexpr.hxx"
@@ -38,6 +39,9 @@
 #include "api/shm/shm.hxx"
 #endif
 #include "api/ext/serialization.hxx"
+#include "api/ext/session_pool.hxx"
+#include "api/ext/shared_subscription.hxx"
+#include "api/ext/typed_pubsub.hxx"
 #if defined(ZENOHCXX_ZENOHC) && defined(Z_FEATURE_UNSTABLE_API)
 #include "api/ext/publication_cache.hxx"
 #include "api/ext/querying_subscriber.hxx"
@@ -15,8 +15,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include "../zenohc.hxx"
 
@@ -33,13 +36,36 @@ class ZException : public std::runtime_error {
         : std::runtime_error(message + "(Error code: " + std::to_string(err) + " )"), e(err) {}
 };
 
-#define __ZENOH_RESULT_CHECK(err, err_ptr, message)        \
-    if (err_ptr == nullptr) {                              \
-        ZResult __ze = err;                                \
-        if (__ze != Z_OK) throw ZException(message, __ze); \
-    } else {                                               \
-        *err_ptr = err;                                    \
-    }
+namespace detail {
+/// @brief Build the error message out of its parts and throw ``ZException``.
+/// Kept out of the success path: the message is only assembled once the error is known.
+/// When exceptions are disabled (``-fno-exceptions``) the message is printed to stderr and the program is aborted;
+/// such builds should use the ``try_*`` functions returning ``Expected``.
+template <class... Parts>
+[[noreturn]] void throw_zexception(ZResult err, const Parts&... parts) {
+    std::string message;
+    (message.append(std::string_view(parts)), ...);
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    throw ZException(message, err);
+#else
+    std::fprintf(stderr, "%s(Error code: %d )\n", message.c_str(), static_cast<int>(err));
+    std::abort();
+#endif
+}
+}  // namespace detail
+
+/// Write the result of `err` into `err_ptr` if it is not null, otherwise throw ``ZException`` in case of error.
+/// The message is passed as a list of parts convertible to ``std::string_view`` which are only evaluated and
+/// concatenated when the exception is thrown, so that successful calls never allocate.
+#define __ZENOH_RESULT_CHECK(err, err_ptr, ...)                       \
+    do {                                                              \
+        ZResult __ze = err;                                           \
+        if (err_ptr != nullptr) {                                     \
+            *err_ptr = __ze;                                          \
+        } else if (__ze != Z_OK) {                                    \
+            ::zenoh::detail::throw_zexception(__ze, __VA_ARGS__);     \
+        }                                                             \
+    } while (0)
 
 //
 // Template base classes implementing common functionality
@@ -31,7 +31,14 @@ class Config : public Owned<::z_owned_config_t> {
     /// thrown in case of error.
     static Config create_default(ZResult* err = nullptr) {
         Config c(zenoh::detail::null_object);
-        __ZENOH_RESULT_CHECK(::z_config_default(&c._0), err, std::string("Failed to create default configuration"));
+        __ZENOH_RESULT_CHECK(::z_config_default(&c._0), err, "Failed to create default configuration");
+        return c;
+    }
+
+    /// @brief Create a copy of this configuration.
+    Config clone() const {
+        Config c(zenoh::detail::null_object);
+        ::z_config_clone(&c._0, interop::as_loaned_c_ptr(*this));
         return c;
     }
 
@@ -46,8 +53,7 @@ class Config : public Owned<::z_owned_config_t> {
     /// @note Zenoh-c only.
     static Config from_file(const std::string& path, ZResult* err = nullptr) {
         Config c(zenoh::detail::null_object);
-        __ZENOH_RESULT_CHECK(::zc_config_from_file(&c._0, path.data()), err,
-                             std::string("Failed to create config from: ").append(path));
+        __ZENOH_RESULT_CHECK(::zc_config_from_file(&c._0, path.data()), err, "Failed to create config from: ", path);
         return c;
     }
 
@@ -59,8 +65,7 @@ class Config : public Owned<::z_owned_config_t> {
     /// @note Zenoh-c only.
     static Config from_str(const std::string& s, ZResult* err = nullptr) {
         Config c(zenoh::detail::null_object);
-        __ZENOH_RESULT_CHECK(::zc_config_from_str(&c._0, s.data()), err,
-                             std::string("Failed to create config from: ").append(s));
+        __ZENOH_RESULT_CHECK(::zc_config_from_str(&c._0, s.data()), err, "Failed to create config from: ", s);
         return c;
     }
 
@@ -88,7 +93,7 @@ class Config : public Owned<::z_owned_config_t> {
     std::string get(std::string_view key, ZResult* err = nullptr) const {
         ::z_owned_string_t s;
         __ZENOH_RESULT_CHECK(::zc_config_get_from_substr(interop::as_loaned_c_ptr(*this), key.data(), key.size(), &s),
-                             err, std::string("Failed to get config value for the key: ").append(key));
+                             err, "Failed to get config value for the key: ", key);
         std::string out = std::string(::z_string_data(::z_loan(s)), ::z_string_len(::z_loan(s)));
         ::z_drop(::z_move(s));
         return out;
@@ -114,11 +119,7 @@ class Config : public Owned<::z_owned_config_t> {
     /// @note Zenoh-c only.
     void insert_json5(const std::string& key, const std::string& value, ZResult* err = nullptr) {
         __ZENOH_RESULT_CHECK(::zc_config_insert_json5(interop::as_loaned_c_ptr(*this), key.c_str(), value.c_str()), err,
-                             std::string("Failed to insert '")
-                                 .append(value)
-                                 .append("' for the key '")
-                                 .append(key)
-                                 .append("' into config"));
+                             "Failed to insert '", value, "' for the key '", key, "' into config");
     }
 #endif
 #ifdef ZENOHCXX_ZENOHPICO
@@ -130,8 +131,8 @@ class Config : public Owned<::z_owned_config_t> {
     /// @note Zenoh-pico only.
     const char* get(uint8_t key, ZResult* err = nullptr) const {
         const char* c = ::zp_config_get(interop::as_loaned_c_ptr(*this), key);
-        __ZENOH_RESULT_CHECK((c == nullptr ? -1 : Z_OK), err,
-                             std::string("Failed to get config value for the key: ").append(std::to_string(key)));
+        __ZENOH_RESULT_CHECK((c == nullptr ? -1 : Z_OK), err, "Failed to get config value for the key: ",
+                             std::to_string(key));
         return c;
     }
 
@@ -143,11 +144,7 @@ class Config : public Owned<::z_owned_config_t> {
     /// @note Zenoh-pico only.
     void insert(uint8_t key, const char* value, ZResult* err = nullptr) {
         __ZENOH_RESULT_CHECK(zp_config_insert(interop::as_loaned_c_ptr(*this), key, value), err,
-                             std::string("Failed to insert '")
-                                 .append(value)
-                                 .append("' for the key '")
-                                 .append(std::to_string(key))
-                                 .append("' into config"));
+                             "Failed to insert '", value, "' for the key '", std::to_string(key), "' into config");
     }
 #endif
 };
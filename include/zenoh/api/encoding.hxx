@@ -31,7 +31,7 @@ class Encoding : public Owned<::z_owned_encoding_t> {
     /// @brief Construct encoding from string.
     Encoding(std::string_view s, ZResult* err = nullptr) : Owned(nullptr) {
         __ZENOH_RESULT_CHECK(::z_encoding_from_substr(&this->_0, s.data(), s.size()), err,
-                             std::string("Failed to create encoding from ").append(s));
+                             "Failed to create encoding from ", s);
     }
 
     /// @brief Copy constructor.
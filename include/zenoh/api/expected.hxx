@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#include "base.hxx"
+
+namespace zenoh {
+
+/// @brief Either a value of type ``T`` or the error code of the operation that failed to produce it.
+///
+/// Returned by the ``try_*`` counterparts of the throwing API. They never throw ``ZException`` nor build error
+/// messages, which makes them suitable for hot paths and for builds with exceptions disabled. The member functions
+/// follow ``std::expected<T, ZResult>``.
+template <class T>
+class Expected {
+   public:
+    /// @name Constructors
+
+    /// @brief Construct from a value.
+    Expected(T&& value) : _value(std::move(value)), _err(Z_OK) {}
+
+    /// @brief Construct from an error code.
+    /// @param err error code, must be different from ``Z_OK``.
+    static Expected from_error(ZResult err) { return Expected(err); }
+
+    /// @name Methods
+
+    /// @brief Check if the operation succeeded.
+    bool has_value() const { return _err == Z_OK; }
+    /// @brief Check if the operation succeeded.
+    explicit operator bool() const { return has_value(); }
+
+    /// @brief Get the error code of the operation, ``Z_OK`` if it succeeded.
+    ZResult error() const { return _err; }
+
+    /// @brief Get the value. Will throw a ZException if the operation failed (or abort if exceptions are disabled).
+    T& value() & {
+        check();
+        return *_value;
+    }
+    /// @brief Get the value. Will throw a ZException if the operation failed (or abort if exceptions are disabled).
+    const T& value() const& {
+        check();
+        return *_value;
+    }
+    /// @brief Take the value. Will throw a ZException if the operation failed (or abort if exceptions are disabled).
+    T&& value() && {
+        check();
+        return std::move(*_value);
+    }
+
+    /// @brief Access the value. The behavior is undefined if the operation failed.
+    T& operator*() & { return *_value; }
+    /// @brief Access the value. The behavior is undefined if the operation failed.
+    const T& operator*() const& { return *_value; }
+    /// @brief Take the value. The behavior is undefined if the operation failed.
+    T&& operator*() && { return std::move(*_value); }
+    /// @brief Access the value. The behavior is undefined if the operation failed.
+    T* operator->() { return &*_value; }
+    /// @brief Access the value. The behavior is undefined if the operation failed.
+    const T* operator->() const { return &*_value; }
+
+   private:
+    explicit Expected(ZResult err) : _value(), _err(err) {}
+
+    void check() const {
+        if (_err != Z_OK) detail::throw_zexception(_err, "Expected value was requested, but operation failed");
+    }
+
+    std::optional<T> _value;
+    ZResult _err;
+};
+
+/// @brief Result of an operation that produces no value: either a success or an error code.
+template <>
+class Expected<void> {
+   public:
+    /// @name Constructors
+
+    /// @brief Construct a successful result.
+    Expected() : _err(Z_OK) {}
+
+    /// @brief Construct from an error code.
+    /// @param err error code, must be different from ``Z_OK``.
+    static Expected from_error(ZResult err) {
+        Expected e;
+        e._err = err;
+        return e;
+    }
+
+    /// @name Methods
+
+    /// @brief Check if the operation succeeded.
+    bool has_value() const { return _err == Z_OK; }
+    /// @brief Check if the operation succeeded.
+    explicit operator bool() const { return has_value(); }
+
+    /// @brief Get the error code of the operation, ``Z_OK`` if it succeeded.
+    ZResult error() const { return _err; }
+
+    /// @brief Will throw a ZException if the operation failed (or abort if exceptions are disabled).
+    void value() const {
+        if (_err != Z_OK) detail::throw_zexception(_err, "Operation failed");
+    }
+
+   private:
+    ZResult _err;
+};
+
+namespace detail {
+/// Wrap the value and the error code produced by an ``err``-reporting call.
+template <class T>
+Expected<T> make_expected(T value, ZResult err) {
+    if (err != Z_OK) return Expected<T>::from_error(err);
+    return Expected<T>(std::move(value));
+}
+
+inline Expected<void> make_expected(ZResult err) {
+    if (err != Z_OK) return Expected<void>::from_error(err);
+    return Expected<void>();
+}
+}  // namespace detail
+
+}  // namespace zenoh
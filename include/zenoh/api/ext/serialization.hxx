@@ -32,6 +32,7 @@
 
 #include "../base.hxx"
 #include "../bytes.hxx"
+#include "../expected.hxx"
 #include "../interop.hxx"
 
 namespace zenoh {
@@ -119,6 +120,16 @@ T deserialize(const zenoh::Bytes& bytes, zenoh::ZResult* err = nullptr) {
     return t;
 }
 
+/// @brief Same as ``deserialize``, but reports errors through the returned value instead of throwing.
+/// @param bytes data to deserialize.
+/// @return deserialized value or the error code.
+template <class T>
+zenoh::Expected<T> try_deserialize(const zenoh::Bytes& bytes) {
+    ZResult err = Z_OK;
+    T t = deserialize<T>(bytes, &err);
+    return zenoh::detail::make_expected(std::move(t), err);
+}
+
 namespace detail {
 template <class T>
 bool serialize_with_serializer(zenoh::ext::Serializer& serializer, const T& t, ZResult* err = nullptr);
@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../base.hxx"
+#include "../config.hxx"
+#include "../session.hxx"
+
+namespace zenoh {
+namespace ext {
+
+/// @brief A pool of sessions opened from the same configuration.
+///
+/// Every session sends through its own transport, so spreading the publications of an application over several
+/// sessions allows its aggregated put rate to scale with the number of cores. Publishers, subscribers and puts are
+/// assigned to a session (a slot of the pool) by the hash of their key expression: all operations on a given key
+/// expression go through the same session and keep their relative order.
+///
+/// The sessions of the pool are distinct Zenoh nodes. Samples published by one of them reach the subscribers declared
+/// on another one through the network, like for any other pair of sessions. The configuration should thus allow
+/// several sessions to run side by side, e.g. it should not make them all listen on the same fixed endpoint.
+class SessionPool {
+   public:
+    /// @brief Statistics of a slot of the pool.
+    struct SlotStats {
+        /// @brief Number of successful ``SessionPool::put`` calls routed to the slot.
+        uint64_t puts = 0;
+        /// @brief Number of failed ``SessionPool::put`` calls routed to the slot.
+        uint64_t put_errors = 0;
+        /// @brief Number of payload bytes successfully put through the slot.
+        uint64_t put_bytes = 0;
+        /// @brief Number of publishers declared on the slot through the pool.
+        uint64_t publishers = 0;
+        /// @brief Number of subscribers declared on the slot through the pool.
+        uint64_t subscribers = 0;
+    };
+
+    /// @name Constructors
+
+    /// @brief Open a pool of sessions.
+    /// @param config Zenoh session ``Config``, cloned for every session of the pool.
+    /// @param size number of sessions to open, must be greater than 0.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error. In case of failure the sessions opened so far are closed and the pool is left empty.
+    SessionPool(Config&& config, size_t size, ZResult* err = nullptr) {
+        if (size == 0) {
+            __ZENOH_RESULT_CHECK(Z_EINVAL, err, "Session pool size must be greater than 0");
+            return;
+        }
+        _slots.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            ZResult res = Z_OK;
+            Session s = Session::open(i + 1 == size ? std::move(config) : config.clone(),
+                                      Session::SessionOptions::create_default(), &res);
+            if (res != Z_OK) {
+                _slots.clear();
+                __ZENOH_RESULT_CHECK(res, err, "Failed to open session ", std::to_string(i), " of the pool");
+                return;
+            }
+            _slots.push_back(std::make_unique<Slot>(std::move(s)));
+        }
+        if (err != nullptr) *err = Z_OK;
+    }
+
+    /// @brief A factory method equivalent to a ``SessionPool`` constructor.
+    /// @param config Zenoh session ``Config``, cloned for every session of the pool.
+    /// @param size number of sessions to open, must be greater than 0.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return ``SessionPool`` object.
+    static SessionPool open(Config&& config, size_t size, ZResult* err = nullptr) {
+        return SessionPool(std::move(config), size, err);
+    }
+
+    /// @name Methods
+
+    /// @brief Get the number of sessions of the pool.
+    size_t size() const { return _slots.size(); }
+
+    /// @brief Get the slot assigned to a key expression.
+    /// @param key_expr the key expression.
+    /// @return index of the slot, in ``[0, size())``.
+    size_t slot_for(const KeyExpr& key_expr) const {
+        return std::hash<std::string_view>{}(key_expr.as_string_view()) % _slots.size();
+    }
+
+    /// @brief Get the session of a slot.
+    /// @param slot index of the slot, in ``[0, size())``.
+    const Session& session(size_t slot) const { return _slots[slot]->session; }
+
+    /// @brief Get the session assigned to a key expression.
+    const Session& session_for(const KeyExpr& key_expr) const { return session(slot_for(key_expr)); }
+
+    /// @brief Get the statistics of a slot.
+    /// @param slot index of the slot, in ``[0, size())``.
+    SlotStats stats(size_t slot) const {
+        const Slot& s = *_slots[slot];
+        SlotStats out;
+        out.puts = s.puts.load(std::memory_order_relaxed);
+        out.put_errors = s.put_errors.load(std::memory_order_relaxed);
+        out.put_bytes = s.put_bytes.load(std::memory_order_relaxed);
+        out.publishers = s.publishers.load(std::memory_order_relaxed);
+        out.subscribers = s.subscribers.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    /// @brief Get the statistics of all slots, indexed by slot.
+    std::vector<SlotStats> stats() const {
+        std::vector<SlotStats> out;
+        out.reserve(_slots.size());
+        for (size_t i = 0; i < _slots.size(); i++) out.push_back(stats(i));
+        return out;
+    }
+
+#if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_PUBLICATION == 1
+    /// @brief Publish data through the session assigned to the key expression. Equivalent to ``Session::put``.
+    /// @param key_expr the key expression to put the data.
+    /// @param payload the data to publish.
+    /// @param options options to pass to put operation.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void put(const KeyExpr& key_expr, Bytes&& payload,
+             Session::PutOptions&& options = Session::PutOptions::create_default(), ZResult* err = nullptr) const {
+        Slot& s = *_slots[slot_for(key_expr)];
+        const size_t len = payload.size();
+        ZResult res = Z_OK;
+        s.session.put(key_expr, std::move(payload), std::move(options), &res);
+        if (res == Z_OK) {
+            s.puts.fetch_add(1, std::memory_order_relaxed);
+            s.put_bytes.fetch_add(len, std::memory_order_relaxed);
+        } else {
+            s.put_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        __ZENOH_RESULT_CHECK(res, err, "Failed to perform put operation");
+    }
+
+    /// @brief Create a ``Publisher`` on the session assigned to the key expression. Equivalent to
+    /// ``Session::declare_publisher``.
+    /// @param key_expr the key expression to match the subscribers.
+    /// @param options options passed to publisher declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return a ``Publisher`` object.
+    Publisher declare_publisher(const KeyExpr& key_expr,
+                                Session::PublisherOptions&& options = Session::PublisherOptions::create_default(),
+                                ZResult* err = nullptr) const {
+        Slot& s = *_slots[slot_for(key_expr)];
+        ZResult res = Z_OK;
+        Publisher p = s.session.declare_publisher(key_expr, std::move(options), &res);
+        if (res == Z_OK) s.publishers.fetch_add(1, std::memory_order_relaxed);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to declare Publisher");
+        return p;
+    }
+#endif
+
+#if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_SUBSCRIPTION == 1
+    /// @brief Create a ``Subscriber`` on the session assigned to the key expression. Equivalent to
+    /// ``Session::declare_subscriber``.
+    /// @param key_expr the key expression to match the publishers.
+    /// @param on_sample the callback that will be called for each received sample.
+    /// @param on_drop the callback that will be called once subscriber is destroyed or undeclared.
+    /// @param options options to pass to subscriber declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return a ``Subscriber`` object.
+    template <class C, class D>
+    [[nodiscard]] Subscriber<void> declare_subscriber(
+        const KeyExpr& key_expr, C&& on_sample, D&& on_drop,
+        Session::SubscriberOptions&& options = Session::SubscriberOptions::create_default(),
+        ZResult* err = nullptr) const {
+        Slot& s = *_slots[slot_for(key_expr)];
+        ZResult res = Z_OK;
+        auto sub = s.session.declare_subscriber(key_expr, std::forward<C>(on_sample), std::forward<D>(on_drop),
+                                                std::move(options), &res);
+        if (res == Z_OK) s.subscribers.fetch_add(1, std::memory_order_relaxed);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to declare Subscriber");
+        return sub;
+    }
+
+    /// @brief Create a ``Subscriber`` on the session assigned to the key expression. Equivalent to
+    /// ``Session::declare_subscriber``.
+    /// @tparam Channel the type of channel used to create stream of data (see ``zenoh::channels::FifoChannel`` or
+    /// ``zenoh::channels::RingChannel``).
+    /// @param key_expr the key expression to match the publishers.
+    /// @param channel an instance of channel.
+    /// @param options options to pass to subscriber declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return a ``Subscriber`` object.
+    template <class Channel>
+    [[nodiscard]] Subscriber<typename Channel::template HandlerType<Sample>> declare_subscriber(
+        const KeyExpr& key_expr, Channel channel,
+        Session::SubscriberOptions&& options = Session::SubscriberOptions::create_default(),
+        ZResult* err = nullptr) const {
+        Slot& s = *_slots[slot_for(key_expr)];
+        ZResult res = Z_OK;
+        auto sub = s.session.declare_subscriber(key_expr, std::move(channel), std::move(options), &res);
+        if (res == Z_OK) s.subscribers.fetch_add(1, std::memory_order_relaxed);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to declare Subscriber");
+        return sub;
+    }
+#endif
+
+    /// @brief Close all the sessions of the pool.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error. The remaining sessions are closed even if closing one of them fails, the error of the
+    /// first failure is reported.
+    void close(ZResult* err = nullptr) {
+        ZResult first = Z_OK;
+        for (auto& s : _slots) {
+            ZResult res = Z_OK;
+            s->session.close(Session::SessionCloseOptions::create_default(), &res);
+            if (first == Z_OK) first = res;
+        }
+        __ZENOH_RESULT_CHECK(first, err, "Failed to close the session pool");
+    }
+
+   private:
+    struct Slot {
+        Session session;
+        std::atomic<uint64_t> puts = 0;
+        std::atomic<uint64_t> put_errors = 0;
+        std::atomic<uint64_t> put_bytes = 0;
+        std::atomic<uint64_t> publishers = 0;
+        std::atomic<uint64_t> subscribers = 0;
+
+        Slot(Session&& s) : session(std::move(s)) {}
+    };
+
+    std::vector<std::unique_ptr<Slot>> _slots;
+};
+
+}  // namespace ext
+}  // namespace zenoh
@@ -0,0 +1,319 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <variant>
+#include <vector>
+
+#include "../base.hxx"
+#include "../channels.hxx"
+#include "../sample.hxx"
+#include "../session.hxx"
+#include "../subscriber.hxx"
+
+#if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_SUBSCRIPTION == 1
+
+namespace zenoh {
+namespace ext {
+
+/// @brief A sample shared by all the consumers of a ``SharedSubscription``.
+using SharedSample = std::shared_ptr<const Sample>;
+
+namespace detail {
+/// A bounded queue of shared samples, filled by the subscription and drained by a single consumer.
+class SharedSampleQueue {
+   public:
+    enum class Policy { Block, DropOldest, DropNewest };
+
+    SharedSampleQueue(size_t capacity, Policy policy) : _capacity(capacity > 0 ? capacity : 1), _policy(policy) {}
+
+    void push(const SharedSample& s) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_closed) return;
+        if (_samples.size() >= _capacity) {
+            switch (_policy) {
+                case Policy::Block:
+                    _not_full.wait(lock, [this] { return _closed || _samples.size() < _capacity; });
+                    if (_closed) return;
+                    break;
+                case Policy::DropOldest:
+                    _samples.pop_front();
+                    _dropped++;
+                    break;
+                case Policy::DropNewest:
+                    _dropped++;
+                    return;
+            }
+        }
+        _samples.push_back(s);
+        lock.unlock();
+        _not_empty.notify_one();
+    }
+
+    std::variant<SharedSample, channels::RecvError> pop(bool wait) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (wait) _not_empty.wait(lock, [this] { return _closed || !_samples.empty(); });
+        if (_samples.empty()) {
+            return _closed ? channels::RecvError::Z_DISCONNECTED : channels::RecvError::Z_NODATA;
+        }
+        SharedSample s = std::move(_samples.front());
+        _samples.pop_front();
+        lock.unlock();
+        _not_full.notify_one();
+        return s;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+   private:
+    mutable std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    std::deque<SharedSample> _samples;
+    size_t _capacity;
+    Policy _policy;
+    uint64_t _dropped = 0;
+    bool _closed = false;
+};
+}  // namespace detail
+
+/// @brief A handler to receive the samples of a ``SharedSubscription`` consumer registered with
+/// ``SharedSubscription::add_channel``.
+class SharedSampleHandler {
+   public:
+    /// @name Methods
+
+    /// @brief Fetch a sample from the buffer, blocking until one is available or the consumer is removed.
+    /// @return a ``SharedSample``, or ``channels::RecvError::Z_DISCONNECTED`` once the consumer has been removed (or
+    /// the subscription undeclared) and all its buffered samples have been fetched.
+    std::variant<SharedSample, channels::RecvError> recv() const { return _queue->pop(true); }
+
+    /// @brief Fetch a sample from the buffer without blocking.
+    /// @return a ``SharedSample``, ``channels::RecvError::Z_NODATA`` if the buffer is empty, or
+    /// ``channels::RecvError::Z_DISCONNECTED`` if, in addition, the consumer has been removed.
+    std::variant<SharedSample, channels::RecvError> try_recv() const { return _queue->pop(false); }
+
+    /// @brief Get the number of samples discarded because the buffer was full.
+    uint64_t dropped() const { return _queue->dropped(); }
+
+    /// @brief Get the id of the consumer, to pass to ``SharedSubscription::remove_consumer``.
+    uint64_t id() const { return _id; }
+
+   private:
+    SharedSampleHandler(uint64_t id, std::shared_ptr<detail::SharedSampleQueue> queue)
+        : _id(id), _queue(std::move(queue)) {}
+
+    uint64_t _id;
+    std::shared_ptr<detail::SharedSampleQueue> _queue;
+
+    friend class SharedSubscription;
+};
+
+/// @brief A subscriber declared once and fanned out to any number of in-process consumers.
+///
+/// Every received sample is cloned once into a ``SharedSample``, which all the consumers then reference: their number
+/// does not change the per-sample cost of the subscription beyond the dispatch itself. Consumers are either callbacks,
+/// invoked on the subscriber thread, or channels with their own buffer capacity and backpressure policy. They can be
+/// added and removed at any time while the subscription is active.
+///
+/// Callback consumers and channels with ``Backpressure::Block`` delay the delivery of the sample to the consumers
+/// registered after them, and of the following samples to all consumers. Use ``Backpressure::DropOldest`` or
+/// ``Backpressure::DropNewest`` for consumers which may fall behind.
+class SharedSubscription {
+   public:
+    /// @brief Behavior of a channel consumer when its buffer is full.
+    enum class Backpressure {
+        /// @brief Block the subscription until the consumer fetches a sample, like ``channels::FifoChannel``.
+        Block,
+        /// @brief Discard the oldest buffered sample, like ``channels::RingChannel``.
+        DropOldest,
+        /// @brief Discard the incoming sample.
+        DropNewest
+    };
+
+    /// @name Constructors
+
+    /// @brief Declare the subscriber shared by all consumers.
+    /// @param session the session to declare the subscriber on.
+    /// @param key_expr the key expression to match the publishers.
+    /// @param options options to pass to subscriber declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    SharedSubscription(const Session& session, const KeyExpr& key_expr,
+                       Session::SubscriberOptions&& options = Session::SubscriberOptions::create_default(),
+                       ZResult* err = nullptr)
+        : _state(std::make_shared<State>()),
+          _subscriber(session.declare_subscriber(
+              key_expr, [state = _state](const Sample& s) { state->dispatch(s); },
+              [state = _state]() { state->close(); }, std::move(options), err)) {}
+
+    /// @name Methods
+
+    /// @brief Register a callback consumer.
+    /// @param on_sample the callback that will be called on the subscriber thread for each received sample, with the
+    /// following signature: ``void on_sample(const SharedSample& sample)``. The callback may keep the sample.
+    /// @return the id of the consumer, to pass to ``remove_consumer``.
+    template <class C>
+    uint64_t add_consumer(C&& on_sample) {
+        static_assert(std::is_invocable_r<void, C, const SharedSample&>::value,
+                      "on_sample should be callable with the following signature: void on_sample(const "
+                      "zenoh::ext::SharedSample& sample)");
+        return _state->add(std::function<void(const SharedSample&)>(std::forward<C>(on_sample)), nullptr);
+    }
+
+    /// @brief Register a channel consumer.
+    /// @param capacity maximum number of samples in the buffer of the consumer.
+    /// @param backpressure behavior of the consumer when its buffer is full.
+    /// @return a handler to receive the samples.
+    SharedSampleHandler add_channel(size_t capacity, Backpressure backpressure = Backpressure::Block) {
+        auto queue = std::make_shared<detail::SharedSampleQueue>(capacity, to_policy(backpressure));
+        uint64_t id = _state->add([queue](const SharedSample& s) { queue->push(s); }, queue);
+        return SharedSampleHandler(id, std::move(queue));
+    }
+
+    /// @brief Unregister a consumer. A channel consumer still delivers its buffered samples, then reports
+    /// ``channels::RecvError::Z_DISCONNECTED``.
+    /// @param id the id of the consumer.
+    /// @return true if the consumer was registered, false otherwise.
+    bool remove_consumer(uint64_t id) { return _state->remove(id); }
+
+    /// @brief Get the number of registered consumers.
+    size_t consumers() const { return _state->consumers(); }
+
+    /// @brief Get the key expression of the subscriber.
+    const KeyExpr& get_keyexpr() const { return _subscriber.get_keyexpr(); }
+
+    /// @brief Undeclare the subscriber. All channel consumers get disconnected once their buffers are drained.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void undeclare(ZResult* err = nullptr) && { std::move(_subscriber).undeclare(err); }
+
+   private:
+    struct Consumer {
+        uint64_t id;
+        std::function<void(const SharedSample&)> on_sample;
+        std::shared_ptr<detail::SharedSampleQueue> queue;
+    };
+    using Consumers = std::vector<Consumer>;
+
+    // Consumers are stored in an immutable list, replaced on every change, so that the dispatch only holds the lock
+    // to take a reference to the current list and never while calling the consumers.
+    struct State {
+        std::mutex mutex;
+        std::shared_ptr<const Consumers> consumers_list = std::make_shared<const Consumers>();
+        uint64_t next_id = 0;
+        bool closed = false;
+
+        std::shared_ptr<const Consumers> snapshot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return consumers_list;
+        }
+
+        void dispatch(const Sample& sample) {
+            auto list = snapshot();
+            if (list->empty()) return;
+            SharedSample s = std::make_shared<const Sample>(sample.clone());
+            for (const auto& c : *list) c.on_sample(s);
+        }
+
+        uint64_t add(std::function<void(const SharedSample&)> on_sample,
+                     std::shared_ptr<detail::SharedSampleQueue> queue) {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t id = next_id++;
+            if (closed) {
+                if (queue != nullptr) queue->close();
+                return id;
+            }
+            auto list = std::make_shared<Consumers>(*consumers_list);
+            list->push_back(Consumer{id, std::move(on_sample), std::move(queue)});
+            consumers_list = std::move(list);
+            return id;
+        }
+
+        bool remove(uint64_t id) {
+            std::shared_ptr<detail::SharedSampleQueue> queue;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto list = std::make_shared<Consumers>();
+                list->reserve(consumers_list->size());
+                for (const auto& c : *consumers_list) {
+                    if (c.id == id) {
+                        queue = c.queue;
+                    } else {
+                        list->push_back(c);
+                    }
+                }
+                if (list->size() == consumers_list->size()) return false;
+                consumers_list = std::move(list);
+            }
+            if (queue != nullptr) queue->close();
+            return true;
+        }
+
+        size_t consumers() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return consumers_list->size();
+        }
+
+        void close() {
+            std::shared_ptr<const Consumers> list;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+                list = std::move(consumers_list);
+                consumers_list = std::make_shared<const Consumers>();
+            }
+            for (const auto& c : *list) {
+                if (c.queue != nullptr) c.queue->close();
+            }
+        }
+    };
+
+    static detail::SharedSampleQueue::Policy to_policy(Backpressure b) {
+        switch (b) {
+            case Backpressure::DropOldest:
+                return detail::SharedSampleQueue::Policy::DropOldest;
+            case Backpressure::DropNewest:
+                return detail::SharedSampleQueue::Policy::DropNewest;
+            default:
+                return detail::SharedSampleQueue::Policy::Block;
+        }
+    }
+
+    std::shared_ptr<State> _state;
+    Subscriber<void> _subscriber;
+};
+
+}  // namespace ext
+}  // namespace zenoh
+
+#endif
@@ -0,0 +1,401 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "../base.hxx"
+#include "../keyexpr.hxx"
+#include "../publisher.hxx"
+#include "../session.hxx"
+#include "../subscriber.hxx"
+#include "serialization.hxx"
+
+#if defined(ZENOHCXX_ZENOHC) || (Z_FEATURE_PUBLICATION == 1 && Z_FEATURE_SUBSCRIPTION == 1)
+
+// Local delivery requires to restrict the destination of the publications to remote subscribers, which is only
+// possible with the zenoh-c unstable API. Otherwise typed publishers always go through serialization.
+#if defined(ZENOHCXX_ZENOHC) && defined(Z_FEATURE_UNSTABLE_API)
+#define __ZENOH_TYPED_LOCAL_DELIVERY
+#endif
+
+namespace zenoh {
+namespace ext {
+
+namespace detail {
+/// The process-wide registry of the typed subscribers, grouped by session.
+class TypedRegistry {
+   public:
+    using SessionKey = std::array<uint8_t, 16>;
+
+    struct Entry {
+        KeyExpr key_expr;
+        std::type_index type;
+        std::function<void(const std::shared_ptr<const void>&)> deliver;
+
+        Entry(KeyExpr&& k, std::type_index t, std::function<void(const std::shared_ptr<const void>&)>&& d)
+            : key_expr(std::move(k)), type(t), deliver(std::move(d)) {}
+
+        // No lock is held while the callback runs, so that it can publish, declare or undeclare typed subscribers.
+        void call(const std::shared_ptr<const void>& value) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_active) return;
+                _in_flight++;
+            }
+            InFlight in_flight(*this);
+            deliver(value);
+        }
+
+        // Waits for the deliveries in progress, except the ones of the calling thread, i.e. when called from a
+        // callback.
+        void deactivate() {
+            size_t own = static_cast<size_t>(std::count(delivering().begin(), delivering().end(), this));
+            std::unique_lock<std::mutex> lock(_mutex);
+            _active = false;
+            _done.wait(lock, [this, own]() { return _in_flight == own; });
+        }
+
+       private:
+        // The entries whose callback runs on the current thread.
+        static std::vector<const Entry*>& delivering() {
+            static thread_local std::vector<const Entry*> entries;
+            return entries;
+        }
+
+        class InFlight {
+           public:
+            InFlight(Entry& entry) : _entry(entry) { delivering().push_back(&entry); }
+            ~InFlight() {
+                delivering().pop_back();
+                {
+                    std::lock_guard<std::mutex> lock(_entry._mutex);
+                    _entry._in_flight--;
+                }
+                _entry._done.notify_all();
+            }
+
+           private:
+            Entry& _entry;
+        };
+
+        std::mutex _mutex;
+        std::condition_variable _done;
+        bool _active = true;
+        size_t _in_flight = 0;
+    };
+
+    using Entries = std::vector<std::shared_ptr<Entry>>;
+
+    static TypedRegistry& instance() {
+        static TypedRegistry registry;
+        return registry;
+    }
+
+    void add(const SessionKey& session, std::shared_ptr<Entry> entry) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[session].push_back(std::move(entry));
+        _version.fetch_add(1, std::memory_order_release);
+    }
+
+    void remove(const SessionKey& session, const std::shared_ptr<Entry>& entry) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(session);
+            if (it != _entries.end()) {
+                auto& v = it->second;
+                for (auto e = v.begin(); e != v.end(); ++e) {
+                    if (*e == entry) {
+                        v.erase(e);
+                        break;
+                    }
+                }
+                if (v.empty()) _entries.erase(it);
+            }
+            _version.fetch_add(1, std::memory_order_release);
+        }
+        entry->deactivate();
+    }
+
+    /// Incremented on every change, to let the publishers know when to refresh their list of local subscribers.
+    uint64_t version() const { return _version.load(std::memory_order_acquire); }
+
+    Entries matching(const SessionKey& session, const KeyExpr& key_expr, std::type_index type) const {
+        Entries out;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(session);
+        if (it == _entries.end()) return out;
+        for (const auto& e : it->second) {
+            if (e->type == type && e->key_expr.intersects(key_expr)) out.push_back(e);
+        }
+        return out;
+    }
+
+   private:
+    mutable std::mutex _mutex;
+    std::map<SessionKey, Entries> _entries;
+    std::atomic<uint64_t> _version = 0;
+};
+}  // namespace detail
+
+/// @brief A publisher of values of type ``T``.
+///
+/// Values are handed as ``std::shared_ptr<const T>`` to the ``TypedSubscriber<T>`` declared on the same session,
+/// without being serialized nor copied, and are serialized with ``zenoh::ext::serialize`` only if there are remote
+/// subscribers matching the key expression. Any ``Subscriber`` declared on another session, in this process or not,
+/// is a remote subscriber.
+///
+/// Local delivery requires the zenoh-c backend with unstable API enabled, see ``local_delivery``: the publications of
+/// the underlying ``Publisher`` are then restricted to remote subscribers, so a plain ``Subscriber`` declared on the
+/// same session does not receive them. Such a subscriber should be replaced by a ``TypedSubscriber<T>``, or declared on
+/// another session. With other backends every value is serialized and goes through Zenoh, and ``TypedSubscriber<T>``
+/// receives it like any other subscriber.
+/// @tparam T the type of the values, it must be supported by ``zenoh::ext::serialize`` and
+/// ``zenoh::ext::deserialize``.
+template <class T>
+class TypedPublisher {
+   public:
+    /// @brief True if values are handed to the ``TypedSubscriber<T>`` of the same session without serialization.
+    static constexpr bool local_delivery =
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        true;
+#else
+        false;
+#endif
+
+    /// @name Constructors
+
+    /// @brief Declare a typed publisher.
+    /// @param session the session to declare the publisher on.
+    /// @param key_expr the key expression to match the subscribers.
+    /// @param options options passed to publisher declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    TypedPublisher(const Session& session, const KeyExpr& key_expr,
+                   Session::PublisherOptions&& options = Session::PublisherOptions::create_default(),
+                   ZResult* err = nullptr)
+        : _publisher(declare(session, key_expr, std::move(options), err)) {
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        _state = std::make_shared<State>(session.get_zid().bytes(), KeyExpr(key_expr.as_string_view()));
+        if (err != nullptr && *err != Z_OK) return;
+        ZResult res = Z_OK;
+        _publisher.declare_background_matching_listener(
+            [state = _state](const Publisher::MatchingStatus& s) {
+                state->remote_matching.store(s.matching, std::memory_order_relaxed);
+            },
+            closures::none, &res);
+        if (res == Z_OK) {
+            _state->remote_matching.store(_publisher.get_matching_status(&res).matching, std::memory_order_relaxed);
+        }
+        // Without matching status, serialize every value.
+        if (res != Z_OK) _state->remote_matching.store(true, std::memory_order_relaxed);
+#else
+        (void)session;
+#endif
+    }
+
+    /// @name Methods
+
+    /// @brief Publish a value.
+    /// @param value the value, shared with the local subscribers.
+    /// @param options options to pass to the put operation of the remote publication.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void put(const std::shared_ptr<const T>& value,
+             Publisher::PutOptions&& options = Publisher::PutOptions::create_default(), ZResult* err = nullptr) const {
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        for (const auto& e : *_state->local_subscribers()) e->call(value);
+        if (!_state->remote_matching.load(std::memory_order_relaxed)) {
+            if (err != nullptr) *err = Z_OK;
+            return;
+        }
+#endif
+        _publisher.put(ext::serialize(*value), std::move(options), err);
+    }
+
+    /// @brief Publish a value.
+    /// @param value the value.
+    /// @param options options to pass to the put operation of the remote publication.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void put(T&& value, Publisher::PutOptions&& options = Publisher::PutOptions::create_default(),
+             ZResult* err = nullptr) const {
+        put(std::make_shared<const T>(std::move(value)), std::move(options), err);
+    }
+
+    /// @brief Get the key expression of the publisher.
+    const KeyExpr& get_keyexpr() const { return _publisher.get_keyexpr(); }
+
+    /// @brief Get the underlying ``Publisher``.
+    const Publisher& publisher() const { return _publisher; }
+
+   private:
+    static Publisher declare(const Session& session, const KeyExpr& key_expr, Session::PublisherOptions&& options,
+                             ZResult* err) {
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        options.allowed_destination = ::ZC_LOCALITY_REMOTE;
+#endif
+        return session.declare_publisher(key_expr, std::move(options), err);
+    }
+
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+    struct State {
+        detail::TypedRegistry::SessionKey session;
+        KeyExpr key_expr;
+        std::atomic<bool> remote_matching = true;
+        std::mutex mutex;
+        uint64_t version = UINT64_MAX;
+        std::shared_ptr<const detail::TypedRegistry::Entries> locals;
+
+        State(const detail::TypedRegistry::SessionKey& s, KeyExpr&& k) : session(s), key_expr(std::move(k)) {}
+
+        // The list is only looked up again after a typed subscriber is declared or undeclared.
+        std::shared_ptr<const detail::TypedRegistry::Entries> local_subscribers() {
+            auto& registry = detail::TypedRegistry::instance();
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t current = registry.version();
+            if (current != version) {
+                locals = std::make_shared<const detail::TypedRegistry::Entries>(
+                    registry.matching(session, key_expr, std::type_index(typeid(T))));
+                version = current;
+            }
+            return locals;
+        }
+    };
+
+    std::shared_ptr<State> _state;
+#endif
+    Publisher _publisher;
+};
+
+/// @brief A subscriber to values of type ``T``, published by ``TypedPublisher<T>`` on the same session or by any
+/// publisher serializing ``T`` with ``zenoh::ext::serialize``.
+///
+/// Samples whose payload can not be deserialized into ``T`` are ignored. The subscriber must not be destroyed or
+/// undeclared from its own callback.
+/// @tparam T the type of the values.
+template <class T>
+class TypedSubscriber {
+   public:
+    /// @name Constructors
+
+    /// @brief Declare a typed subscriber.
+    /// @param session the session to declare the subscriber on.
+    /// @param key_expr the key expression to match the publishers.
+    /// @param on_value the callback that will be called for each received value, with the following signature:
+    /// ``void on_value(const std::shared_ptr<const T>& value)``. The value is shared with the other local subscribers.
+    /// @param options options to pass to subscriber declaration.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    template <class C>
+    TypedSubscriber(const Session& session, const KeyExpr& key_expr, C&& on_value,
+                    Session::SubscriberOptions&& options = Session::SubscriberOptions::create_default(),
+                    ZResult* err = nullptr)
+        : _on_value(std::make_shared<Callback>(std::forward<C>(on_value))),
+          _subscriber(session.declare_subscriber(
+              key_expr,
+              [cb = _on_value](const Sample& sample) {
+                  auto v = ext::try_deserialize<T>(sample.get_payload());
+                  if (v.has_value()) (*cb)(std::make_shared<const T>(std::move(v).value()));
+              },
+              closures::none, std::move(options), err)) {
+        static_assert(std::is_invocable_r<void, C, const std::shared_ptr<const T>&>::value,
+                      "on_value should be callable with the following signature: void on_value(const "
+                      "std::shared_ptr<const T>& value)");
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        if (err != nullptr && *err != Z_OK) return;
+        _registration = Registration(
+            session.get_zid().bytes(),
+            std::make_shared<detail::TypedRegistry::Entry>(
+                KeyExpr(key_expr.as_string_view()), std::type_index(typeid(T)),
+                [cb = _on_value](const std::shared_ptr<const void>& v) {
+                    (*cb)(std::static_pointer_cast<const T>(v));
+                }));
+#endif
+    }
+
+    /// @name Methods
+
+    /// @brief Get the key expression of the subscriber.
+    const KeyExpr& get_keyexpr() const { return _subscriber.get_keyexpr(); }
+
+    /// @brief Undeclare the subscriber.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void undeclare(ZResult* err = nullptr) && {
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+        _registration = Registration();
+#endif
+        std::move(_subscriber).undeclare(err);
+    }
+
+   private:
+    using Callback = std::function<void(const std::shared_ptr<const T>&)>;
+
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+    // Keeps the subscriber in the local registry for its lifetime.
+    class Registration {
+       public:
+        Registration() = default;
+        Registration(const detail::TypedRegistry::SessionKey& session,
+                     std::shared_ptr<detail::TypedRegistry::Entry> entry)
+            : _session(session), _entry(std::move(entry)) {
+            detail::TypedRegistry::instance().add(_session, _entry);
+        }
+        Registration(Registration&& other) : _session(other._session), _entry(std::move(other._entry)) {}
+        Registration& operator=(Registration&& other) {
+            if (this != &other) {
+                reset();
+                _session = other._session;
+                _entry = std::move(other._entry);
+            }
+            return *this;
+        }
+        ~Registration() { reset(); }
+
+       private:
+        void reset() {
+            if (_entry != nullptr) detail::TypedRegistry::instance().remove(_session, _entry);
+            _entry.reset();
+        }
+
+        detail::TypedRegistry::SessionKey _session = {};
+        std::shared_ptr<detail::TypedRegistry::Entry> _entry;
+    };
+#endif
+
+    std::shared_ptr<Callback> _on_value;
+    Subscriber<void> _subscriber;
+#ifdef __ZENOH_TYPED_LOCAL_DELIVERY
+    Registration _registration;
+#endif
+};
+
+}  // namespace ext
+}  // namespace zenoh
+
+#undef __ZENOH_TYPED_LOCAL_DELIVERY
+
+#endif
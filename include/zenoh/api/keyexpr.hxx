@@ -16,6 +16,7 @@
 
 #include "../zenohc.hxx"
 #include "base.hxx"
+#include "expected.hxx"
 #include "interop.hxx"
 
 namespace zenoh {
@@ -43,10 +44,10 @@ class KeyExpr : public Owned<::z_owned_keyexpr_t> {
         if (autocanonize) {
             size_t s = key_expr.size();
             __ZENOH_RESULT_CHECK(::z_keyexpr_from_substr_autocanonize(&this->_0, key_expr.data(), &s), err,
-                                 std::string("Failed to construct KeyExpr from: ").append(key_expr));
+                                 "Failed to construct KeyExpr from: ", key_expr);
         } else {
             __ZENOH_RESULT_CHECK(::z_keyexpr_from_substr(&this->_0, key_expr.data(), key_expr.size()), err,
-                                 std::string("Failed to construct KeyExpr from: ").append(key_expr));
+                                 "Failed to construct KeyExpr from: ", key_expr);
         }
     }
 
@@ -68,6 +69,17 @@ class KeyExpr : public Owned<::z_owned_keyexpr_t> {
     KeyExpr(const char* key_expr, bool autocanonize = true, ZResult* err = nullptr)
         : KeyExpr(std::string_view(key_expr), autocanonize, err){};
 
+    /// @brief Create a new instance from a string, reporting errors through the returned value instead of throwing.
+    ///
+    /// @param key_expr string representing key expression.
+    /// @param autocanonize if ``true`` the key_expr will be autocanonized, prior to constructing key expression.
+    /// @return the key expression or the error code.
+    static Expected<KeyExpr> try_from(std::string_view key_expr, bool autocanonize = true) {
+        ZResult err = Z_OK;
+        KeyExpr k(key_expr, autocanonize, &err);
+        return detail::make_expected(std::move(k), err);
+    }
+
     /// @name Methods
     /// @brief Get underlying key expression string.
     std::string_view as_string_view() const {
@@ -92,12 +104,20 @@ class KeyExpr : public Owned<::z_owned_keyexpr_t> {
     /// @return a new key expression.
     KeyExpr concat(std::string_view s, ZResult* err = nullptr) const {
         KeyExpr k(zenoh::detail::null_object);
-        __ZENOH_RESULT_CHECK(
-            ::z_keyexpr_concat(&k._0, interop::as_loaned_c_ptr(*this), s.data(), s.size()), err,
-            std::string("Failed to concatenate KeyExpr: ").append(this->as_string_view()).append(" with ").append(s));
+        __ZENOH_RESULT_CHECK(::z_keyexpr_concat(&k._0, interop::as_loaned_c_ptr(*this), s.data(), s.size()), err,
+                             "Failed to concatenate KeyExpr: ", this->as_string_view(), " with ", s);
         return k;
     }
 
+    /// @brief Same as ``KeyExpr::concat``, but reports errors through the returned value instead of throwing.
+    /// @param s a string to concatenate with the key expression.
+    /// @return a new key expression or the error code.
+    Expected<KeyExpr> try_concat(std::string_view s) const {
+        ZResult err = Z_OK;
+        KeyExpr k = concat(s, &err);
+        return detail::make_expected(std::move(k), err);
+    }
+
     /// @brief Construct new key expression by joining it with another one.
     /// @param other the ``KeyExpr`` to append.
     /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
@@ -105,14 +125,19 @@ class KeyExpr : public Owned<::z_owned_keyexpr_t> {
     KeyExpr join(const KeyExpr& other, ZResult* err = nullptr) const {
         KeyExpr k(zenoh::detail::null_object);
         __ZENOH_RESULT_CHECK(::z_keyexpr_join(&k._0, interop::as_loaned_c_ptr(*this), interop::as_loaned_c_ptr(other)),
-                             err,
-                             std::string("Failed to join KeyExpr: ")
-                                 .append(this->as_string_view())
-                                 .append(" with ")
-                                 .append(other.as_string_view()));
+                             err, "Failed to join KeyExpr: ", this->as_string_view(), " with ", other.as_string_view());
         return k;
     }
 
+    /// @brief Same as ``KeyExpr::join``, but reports errors through the returned value instead of throwing.
+    /// @param other the ``KeyExpr`` to append.
+    /// @return a new key expression or the error code.
+    Expected<KeyExpr> try_join(const KeyExpr& other) const {
+        ZResult err = Z_OK;
+        KeyExpr k = join(other, &err);
+        return detail::make_expected(std::move(k), err);
+    }
+
     /// @brief Check if 2 key expressions intersect.
     ///
     /// @return ``true`` if there is at least one non-empty key that is contained in both key expressions, ``false``
@@ -20,6 +20,7 @@
 #include "bytes.hxx"
 #include "encoding.hxx"
 #include "enums.hxx"
+#include "expected.hxx"
 #include "interop.hxx"
 #include "keyexpr.hxx"
 #include "timestamp.hxx"
@@ -104,6 +105,16 @@ class Publisher : public Owned<::z_owned_publisher_t> {
                              "Failed to perform put operation");
     }
 
+    /// @brief Same as ``Publisher::put``, but reports errors through the returned value instead of throwing.
+    /// @param payload data to publish.
+    /// @param options optional parameters to pass to put operation.
+    /// @return the error code of the operation.
+    Expected<void> try_put(Bytes&& payload, PutOptions&& options = PutOptions::create_default()) const {
+        ZResult err = Z_OK;
+        put(std::move(payload), std::move(options), &err);
+        return detail::make_expected(err);
+    }
+
     /// @brief Undeclare the resource associated with the publisher key expression.
     /// @param options optional parameters to pass to delete operation.
     /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
@@ -57,7 +57,7 @@ class Reply : public Owned<::z_owned_reply_t> {
     /// @return reply sample.
     const Sample& get_ok() const {
         if (!::z_reply_is_ok(interop::as_loaned_c_ptr(*this))) {
-            throw ZException("Reply data sample was requested, but reply contains error", Z_EINVAL);
+            detail::throw_zexception(Z_EINVAL, "Reply data sample was requested, but reply contains error");
         }
         return interop::as_owned_cpp_ref<Sample>(::z_reply_ok(interop::as_loaned_c_ptr(*this)));
     }
@@ -66,7 +66,7 @@ class Reply : public Owned<::z_owned_reply_t> {
     /// @return reply error.
     const ReplyError& get_err() const {
         if (::z_reply_is_ok(interop::as_loaned_c_ptr(*this))) {
-            throw ZException("Reply error was requested, but reply contains data sample", Z_EINVAL);
+            detail::throw_zexception(Z_EINVAL, "Reply error was requested, but reply contains data sample");
         }
         return interop::as_owned_cpp_ref<ReplyError>(::z_reply_err(interop::as_loaned_c_ptr(*this)));
     }
@@ -21,6 +21,7 @@
 #include "closures.hxx"
 #include "config.hxx"
 #include "enums.hxx"
+#include "expected.hxx"
 #include "id.hxx"
 #include "interop.hxx"
 #include "keyexpr.hxx"
@@ -155,10 +156,20 @@ class Session : public Owned<::z_owned_session_t> {
         KeyExpr k = interop::detail::null<KeyExpr>();
         __ZENOH_RESULT_CHECK(::z_declare_keyexpr(interop::as_loaned_c_ptr(*this), interop::as_owned_c_ptr(k),
                                                  interop::as_loaned_c_ptr(key_expr)),
-                             err, std::string("Failed to declare key expression: ").append(k.as_string_view()));
+                             err, "Failed to declare key expression: ", key_expr.as_string_view());
         return k;
     }
 
+    /// @brief Same as ``Session::declare_keyexpr``, but reports errors through the returned value instead of
+    /// throwing.
+    /// @param key_expr ``KeyExpr`` to declare.
+    /// @return declared ``KeyExpr`` instance or the error code.
+    Expected<KeyExpr> try_declare_keyexpr(const KeyExpr& key_expr) const {
+        ZResult err = Z_OK;
+        KeyExpr k = declare_keyexpr(key_expr, &err);
+        return detail::make_expected(std::move(k), err);
+    }
+
     /// @brief Remove ``KeyExpr`` instance from ``Session`` routing table and drop ``KeyExpr`` instance.
     /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
     /// thrown in case of error.
@@ -296,6 +307,40 @@ class Session : public Owned<::z_owned_session_t> {
         if (res != Z_OK) ::z_drop(interop::as_moved_c_ptr(cb_handler_pair.second));
         return std::move(cb_handler_pair.second);
     }
+
+    /// @brief Same as ``Session::get`` with callbacks, but reports errors through the returned value instead of
+    /// throwing.
+    /// @param key_expr ``KeyExpr`` the key expression matching resources to query.
+    /// @param parameters the parameters string in URL format.
+    /// @param on_reply callable that will be called once for each received reply.
+    /// @param on_drop callable that will be called once all replies are received.
+    /// @param options ``GetOptions`` query options.
+    /// @return the error code of the operation.
+    template <class C, class D>
+    Expected<void> try_get(const KeyExpr& key_expr, const std::string& parameters, C&& on_reply, D&& on_drop,
+                           GetOptions&& options = GetOptions::create_default()) const {
+        ZResult err = Z_OK;
+        get(key_expr, parameters, std::forward<C>(on_reply), std::forward<D>(on_drop), std::move(options), &err);
+        return detail::make_expected(err);
+    }
+
+    /// @brief Same as ``Session::get`` with a channel, but reports errors through the returned value instead of
+    /// throwing.
+    /// @tparam Channel the type of channel used to create stream of data (see ``zenoh::channels::FifoChannel`` or
+    /// ``zenoh::channels::RingChannel``).
+    /// @param key_expr the key expression matching resources to query.
+    /// @param parameters the parameters string in URL format.
+    /// @param channel channel instance.
+    /// @param options query options.
+    /// @return reply handler or the error code.
+    template <class Channel>
+    Expected<typename Channel::template HandlerType<Reply>> try_get(
+        const KeyExpr& key_expr, const std::string& parameters, Channel channel,
+        GetOptions&& options = GetOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto handler = get(key_expr, parameters, std::move(channel), std::move(options), &err);
+        return detail::make_expected(std::move(handler), err);
+    }
 #endif
 #if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_QUERYABLE == 1
     /// @brief Options to be passed when declaring a ``Queryable``
@@ -401,6 +446,40 @@ class Session : public Owned<::z_owned_session_t> {
         return Queryable<typename Channel::template HandlerType<Query>>(std::move(q),
                                                                         std::move(cb_handler_pair.second));
     }
+
+    /// @brief Same as ``Session::declare_queryable`` with callbacks, but reports errors through the returned value
+    /// instead of throwing.
+    /// @param key_expr the key expression to match the ``Session::get`` requests.
+    /// @param on_query the callable to handle ``Query`` requests. Will be called once for each query.
+    /// @param on_drop the drop callable. Will be called once, when ``Queryable`` is destroyed or undeclared.
+    /// @param options options passed to queryable declaration.
+    /// @return a ``Queryable`` object or the error code.
+    template <class C, class D>
+    [[nodiscard]] Expected<Queryable<void>> try_declare_queryable(
+        const KeyExpr& key_expr, C&& on_query, D&& on_drop,
+        QueryableOptions&& options = QueryableOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto q = declare_queryable(key_expr, std::forward<C>(on_query), std::forward<D>(on_drop), std::move(options),
+                                   &err);
+        return detail::make_expected(std::move(q), err);
+    }
+
+    /// @brief Same as ``Session::declare_queryable`` with a channel, but reports errors through the returned value
+    /// instead of throwing.
+    /// @tparam Channel the type of channel used to create stream of data (see ``zenoh::channels::FifoChannel`` or
+    /// ``zenoh::channels::RingChannel``).
+    /// @param key_expr the key expression to match the ``Session::get`` requests.
+    /// @param channel an instance of channel.
+    /// @param options options passed to queryable declaration.
+    /// @return a ``Queryable`` object or the error code.
+    template <class Channel>
+    [[nodiscard]] Expected<Queryable<typename Channel::template HandlerType<Query>>> try_declare_queryable(
+        const KeyExpr& key_expr, Channel channel,
+        QueryableOptions&& options = QueryableOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto q = declare_queryable(key_expr, std::move(channel), std::move(options), &err);
+        return detail::make_expected(std::move(q), err);
+    }
 #endif
 #if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_SUBSCRIPTION == 1
     /// @brief Options to be passed when declaring a ``Subscriber``.
@@ -506,6 +585,40 @@ class Session : public Owned<::z_owned_session_t> {
         return Subscriber<typename Channel::template HandlerType<Sample>>(std::move(s),
                                                                           std::move(cb_handler_pair.second));
     }
+
+    /// @brief Same as ``Session::declare_subscriber`` with callbacks, but reports errors through the returned value
+    /// instead of throwing.
+    /// @param key_expr the key expression to match the publishers.
+    /// @param on_sample the callback that will be called for each received sample.
+    /// @param on_drop the callback that will be called once subscriber is destroyed or undeclared.
+    /// @param options options to pass to subscriber declaration.
+    /// @return a ``Subscriber`` object or the error code.
+    template <class C, class D>
+    [[nodiscard]] Expected<Subscriber<void>> try_declare_subscriber(
+        const KeyExpr& key_expr, C&& on_sample, D&& on_drop,
+        SubscriberOptions&& options = SubscriberOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto s = declare_subscriber(key_expr, std::forward<C>(on_sample), std::forward<D>(on_drop),
+                                    std::move(options), &err);
+        return detail::make_expected(std::move(s), err);
+    }
+
+    /// @brief Same as ``Session::declare_subscriber`` with a channel, but reports errors through the returned value
+    /// instead of throwing.
+    /// @tparam Channel the type of channel used to create stream of data (see ``zenoh::channels::FifoChannel`` or
+    /// ``zenoh::channels::RingChannel``).
+    /// @param key_expr the key expression to match the publishers.
+    /// @param channel an instance of channel.
+    /// @param options options to pass to subscriber declaration.
+    /// @return a ``Subscriber`` object or the error code.
+    template <class Channel>
+    [[nodiscard]] Expected<Subscriber<typename Channel::template HandlerType<Sample>>> try_declare_subscriber(
+        const KeyExpr& key_expr, Channel channel,
+        SubscriberOptions&& options = SubscriberOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto s = declare_subscriber(key_expr, std::move(channel), std::move(options), &err);
+        return detail::make_expected(std::move(s), err);
+    }
 #endif
 #if defined(ZENOHCXX_ZENOHC) || Z_FEATURE_PUBLICATION == 1
     /// @brief Options to be passed to ``delete_resource`` operation
@@ -624,6 +737,18 @@ class Session : public Owned<::z_owned_session_t> {
             ::z_put(interop::as_loaned_c_ptr(*this), interop::as_loaned_c_ptr(key_expr), payload_ptr, &opts), err,
             "Failed to perform put operation");
     }
+
+    /// @brief Same as ``Session::put``, but reports errors through the returned value instead of throwing.
+    /// @param key_expr the key expression to put the data.
+    /// @param payload the data to publish.
+    /// @param options options to pass to put operation.
+    /// @return the error code of the operation.
+    Expected<void> try_put(const KeyExpr& key_expr, Bytes&& payload,
+                           PutOptions&& options = PutOptions::create_default()) const {
+        ZResult err = Z_OK;
+        put(key_expr, std::move(payload), std::move(options), &err);
+        return detail::make_expected(err);
+    }
     /// @brief Options to be passed when declaring a ``Publisher``.
     struct PublisherOptions {
         /// @name Fields
@@ -684,6 +809,18 @@ class Session : public Owned<::z_owned_session_t> {
         __ZENOH_RESULT_CHECK(res, err, "Failed to declare Publisher");
         return p;
     }
+
+    /// @brief Same as ``Session::declare_publisher``, but reports errors through the returned value instead of
+    /// throwing.
+    /// @param key_expr the key expression to match the subscribers.
+    /// @param options options passed to publisher declaration.
+    /// @return a ``Publisher`` object or the error code.
+    Expected<Publisher> try_declare_publisher(const KeyExpr& key_expr,
+                                              PublisherOptions&& options = PublisherOptions::create_default()) const {
+        ZResult err = Z_OK;
+        auto p = declare_publisher(key_expr, std::move(options), &err);
+        return detail::make_expected(std::move(p), err);
+    }
 #endif
     /// @brief Fetches the Zenoh IDs of all connected routers.
     /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <variant>
+#include <vector>
+
+#include "../../base.hxx"
+#include "../../bytes.hxx"
+#include "../provider/shm_provider.hxx"
+#include "../provider/stats.hxx"
+#include "../provider/types.hxx"
+#include "typed_buffer.hxx"
+#include "zshm.hxx"
+#include "zshmmut.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A writer building a ``Bytes`` out of SHM buffers, for payloads whose size is not known in advance.
+///
+/// Data is appended to a chain of SHM chunks allocated from a ``ShmProvider`` on demand, each chunk twice as large as
+/// the previous one up to ``ShmBytesWriterOptions::max_chunk_size``. Producers can either copy data in with
+/// ``write_all``, or write directly into the chunks with ``next_buffer`` and ``commit``, e.g. as the output buffer of
+/// an encoder.
+///
+/// ``finish`` turns the chunks into the slices of the resulting ``Bytes`` without copying them, except the tail of
+/// the last chunk, which is copied into a buffer of its exact size. With ``ShmBytesWriterOptions::compact``, the data
+/// is instead copied into a single SHM buffer, so that the payload can be read with ``Bytes::as_shm``.
+class ShmBytesWriter {
+   public:
+    /// @brief Options to be passed when constructing ``ShmBytesWriter``.
+    struct ShmBytesWriterOptions {
+        /// @name Fields
+
+        /// @brief Size of the first chunk.
+        size_t initial_chunk_size = 4096;
+        /// @brief Maximum size of the chunks. Chunks stop growing once they reach this size.
+        size_t max_chunk_size = 1024 * 1024;
+        /// @brief Alignment of the chunks.
+        AllocAlignment alignment = AllocAlignment({0});
+        /// @brief The provider allocation method to use. ``AllocPolicy::GcDefragAsync`` waits for the allocation
+        /// like ``AllocPolicy::GcDefragBlocking``.
+        AllocPolicy policy = AllocPolicy::GcDefrag;
+        /// @brief If true, ``finish`` copies the data into a single SHM buffer.
+        bool compact = false;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmBytesWriterOptions create_default() { return {}; }
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new writer. No memory is allocated until data is written.
+    /// @param provider the provider to allocate the chunks from, which must outlive the writer.
+    /// @param options options of the writer.
+    ShmBytesWriter(const ShmProvider& provider,
+                   ShmBytesWriterOptions&& options = ShmBytesWriterOptions::create_default())
+        : _provider(provider), _options(std::move(options)) {
+        if (_options.initial_chunk_size == 0) _options.initial_chunk_size = 1;
+        _options.max_chunk_size = std::max(_options.max_chunk_size, _options.initial_chunk_size);
+        _next_chunk_size = _options.initial_chunk_size;
+    }
+
+    ShmBytesWriter(const ShmBytesWriter&) = delete;
+    ShmBytesWriter& operator=(const ShmBytesWriter&) = delete;
+    ShmBytesWriter(ShmBytesWriter&&) = default;
+
+    /// @name Methods
+
+    /// @brief Copy data at the end of the writer.
+    /// @param src source to copy data from.
+    /// @param len number of bytes to copy.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error. Data written before a failed allocation is kept.
+    void write_all(const uint8_t* src, size_t len, ZResult* err = nullptr) {
+        while (len > 0) {
+            ShmSpan<uint8_t> buf = next_buffer(err);
+            if (buf.empty()) return;
+            size_t n = std::min(len, buf.size());
+            std::memcpy(buf.data(), src, n);
+            commit(n);
+            src += n;
+            len -= n;
+        }
+        if (err != nullptr) *err = Z_OK;
+    }
+
+    /// @brief Get the unused part of the current chunk, allocating a new chunk if it is full.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return the writable memory, to be followed by ``commit`` with the number of bytes written to it, or an empty
+    /// span if a chunk could not be allocated.
+    ShmSpan<uint8_t> next_buffer(ZResult* err = nullptr) {
+        ZResult res = Z_OK;
+        if (_chunks.empty() || _used == _chunks.back().len()) res = grow();
+        __ZENOH_RESULT_CHECK(res, err, "Failed to allocate SHM chunk");
+        if (res != Z_OK) return ShmSpan<uint8_t>();
+        ZShmMut& chunk = _chunks.back();
+        return ShmSpan<uint8_t>(chunk.data() + _used, chunk.len() - _used);
+    }
+
+    /// @brief Mark bytes of the buffer returned by ``next_buffer`` as written.
+    /// @param len number of bytes written, at most the size of the buffer.
+    void commit(size_t len) {
+        if (_chunks.empty()) return;
+        len = std::min(len, _chunks.back().len() - _used);
+        _used += len;
+        _size += len;
+    }
+
+    /// @brief Get the number of bytes written.
+    size_t size() const { return _size; }
+
+    /// @brief Get the number of chunks allocated.
+    size_t chunk_count() const { return _chunks.size(); }
+
+    /// @brief Finalize all writes and return the resulting ``Bytes``.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    /// @return the data, one slice per chunk, or a single slice if ``ShmBytesWriterOptions::compact`` is set.
+    Bytes finish(ZResult* err = nullptr) && {
+        ZResult res = Z_OK;
+        if (_options.compact && _chunks.size() > 1) res = compact();
+        if (res == Z_OK) res = trim();
+        __ZENOH_RESULT_CHECK(res, err, "Failed to allocate SHM buffer to finish SHM bytes");
+        if (res != Z_OK) return Bytes();
+        Bytes::Writer writer;
+        for (auto& chunk : _chunks) {
+            writer.append(Bytes(std::move(chunk)), &res);
+            if (res != Z_OK) break;
+        }
+        _chunks.clear();
+        __ZENOH_RESULT_CHECK(res, err, "Failed to append SHM chunk");
+        if (res != Z_OK) return Bytes();
+        return std::move(writer).finish();
+    }
+
+   private:
+    ZResult grow() {
+        size_t size = _next_chunk_size;
+        auto result = detail::alloc_with_policy(_provider, size, _options.alignment, _options.policy);
+        if (!std::holds_alternative<ZShmMut>(result)) return Z_EINVAL;
+        _chunks.push_back(std::get<ZShmMut>(std::move(result)));
+        _used = 0;
+        _next_chunk_size = std::min(size * 2, _options.max_chunk_size);
+        return Z_OK;
+    }
+
+    // Copies all chunks into a single one.
+    ZResult compact() {
+        auto result = detail::alloc_with_policy(_provider, _size, _options.alignment, _options.policy);
+        if (!std::holds_alternative<ZShmMut>(result)) return Z_EINVAL;
+        ZShmMut buf = std::get<ZShmMut>(std::move(result));
+        size_t offset = 0;
+        for (size_t i = 0; i < _chunks.size(); i++) {
+            size_t len = i + 1 == _chunks.size() ? _used : _chunks[i].len();
+            std::memcpy(buf.data() + offset, _chunks[i].data(), len);
+            offset += len;
+        }
+        _chunks.clear();
+        _used = buf.len();
+        _chunks.push_back(std::move(buf));
+        return Z_OK;
+    }
+
+    // Replaces the last chunk by a copy of its used part, since a SHM buffer is always published whole.
+    ZResult trim() {
+        if (_chunks.empty() || _used == _chunks.back().len()) return Z_OK;
+        if (_used == 0) {
+            _chunks.pop_back();
+            return Z_OK;
+        }
+        auto result = detail::alloc_with_policy(_provider, _used, _options.alignment, _options.policy);
+        if (!std::holds_alternative<ZShmMut>(result)) return Z_EINVAL;
+        ZShmMut buf = std::get<ZShmMut>(std::move(result));
+        std::memcpy(buf.data(), _chunks.back().data(), _used);
+        _chunks.pop_back();
+        _chunks.push_back(std::move(buf));
+        _used = _chunks.back().len();
+        return Z_OK;
+    }
+
+    const ShmProvider& _provider;
+    ShmBytesWriterOptions _options;
+    std::vector<ZShmMut> _chunks;
+    size_t _used = 0;
+    size_t _size = 0;
+    size_t _next_chunk_size = 0;
+};
+
+}  // end of namespace zenoh
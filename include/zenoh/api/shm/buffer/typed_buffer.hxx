@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <variant>
+
+#include "../../base.hxx"
+#include "../../bytes.hxx"
+#include "../../interop.hxx"
+#include "../provider/alloc_layout.hxx"
+#include "../provider/shm_provider.hxx"
+#include "zshm.hxx"
+#include "zshmmut.hxx"
+
+namespace zenoh {
+
+namespace detail {
+template <class T>
+AllocAlignment typed_alignment() {
+    static_assert((alignof(T) & (alignof(T) - 1)) == 0, "Alignment must be a power of two");
+    uint8_t pow = 0;
+    while ((size_t(1) << pow) < alignof(T)) pow++;
+    return AllocAlignment({pow});
+}
+
+/// Checks that a buffer holds a whole number of correctly aligned ``T``, at least ``min_count`` of them.
+template <class T>
+ZResult check_typed_buffer(const uint8_t* data, size_t len, size_t min_count) {
+    if (data == nullptr || reinterpret_cast<uintptr_t>(data) % alignof(T) != 0 || len % sizeof(T) != 0 ||
+        len / sizeof(T) < min_count) {
+        return Z_EINVAL;
+    }
+    return Z_OK;
+}
+
+template <class T>
+T* construct_typed_buffer(uint8_t* data, size_t count) {
+    // Default-initialization of trivial types starts the lifetime of the objects without touching the memory.
+    for (size_t i = 0; i < count; i++) ::new (static_cast<void*>(data + i * sizeof(T))) T;
+    return std::launder(reinterpret_cast<T*>(data));
+}
+}  // namespace detail
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A non-owning view of a contiguous sequence of ``T`` in a SHM buffer, ``T`` may be const-qualified.
+template <class T>
+class ShmSpan {
+   public:
+    /// @name Constructors
+
+    /// @brief Create an empty span.
+    ShmSpan() = default;
+
+    /// @brief Create a span of ``size`` elements starting at ``data``.
+    ShmSpan(T* data, size_t size) : _data(data), _size(size) {}
+
+    /// @brief Create a span of const elements from a span of mutable ones.
+    template <class U, class = std::enable_if_t<std::is_same_v<const U, T>>>
+    ShmSpan(const ShmSpan<U>& other) : _data(other.data()), _size(other.size()) {}
+
+    /// @name Methods
+
+    /// @brief Get the pointer to the first element.
+    T* data() const { return _data; }
+    /// @brief Get the number of elements.
+    size_t size() const { return _size; }
+    /// @brief Check if the span is empty.
+    bool empty() const { return _size == 0; }
+    T* begin() const { return _data; }
+    T* end() const { return _data + _size; }
+    T& operator[](size_t i) const { return _data[i]; }
+
+    /// @brief Get a span of ``count`` elements starting at ``offset``, clamped to the end of this span.
+    ShmSpan subspan(size_t offset, size_t count) const {
+        if (offset > _size) offset = _size;
+        if (count > _size - offset) count = _size - offset;
+        return ShmSpan(_data + offset, count);
+    }
+
+   private:
+    T* _data = nullptr;
+    size_t _size = 0;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief An array of trivially copyable ``T`` owning a mutable SHM buffer, to be filled and then published without
+/// copies.
+///
+/// The elements are default-initialized: their value is whatever the buffer contains until they are written.
+template <class T>
+class ShmArray {
+    static_assert(std::is_trivially_copyable_v<T>, "ShmArray requires a trivially copyable type");
+
+   public:
+    /// @name Constructors
+
+    /// @brief Create an array over a buffer.
+    /// @param buf buffer aligned for ``T``, e.g. allocated from a layout created by ``ShmArray::create_layout``. Its
+    /// length must be a multiple of ``sizeof(T)``.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    ShmArray(ZShmMut&& buf, ZResult* err = nullptr) : _buf(std::move(buf)) {
+        ZResult res = detail::check_typed_buffer<T>(_buf.data(), _buf.len(), 0);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to create ShmArray: the buffer is misaligned or has a partial element");
+        if (res != Z_OK) return;
+        _size = _buf.len() / sizeof(T);
+        _data = detail::construct_typed_buffer<T>(_buf.data(), _size);
+    }
+
+    /// @name Methods
+
+    /// @brief Get the alignment of the buffers needed for ``T``.
+    static AllocAlignment alignment() { return detail::typed_alignment<T>(); }
+
+    /// @brief Create a layout allocating buffers for arrays of ``count`` elements.
+    /// @param provider the provider to allocate from.
+    /// @param count number of elements.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    static AllocLayout create_layout(const ShmProvider& provider, size_t count, ZResult* err = nullptr) {
+        return AllocLayout(provider, count * sizeof(T), alignment(), err);
+    }
+
+    /// @brief Create an array from the result of an allocation, e.g. ``ShmArray<float>::from(layout.alloc_gc())``.
+    /// @return the array or the allocation error.
+    static std::variant<ShmArray, AllocError> from(BufAllocResult&& result) {
+        if (auto* error = std::get_if<AllocError>(&result)) return *error;
+        return ShmArray(std::get<ZShmMut>(std::move(result)));
+    }
+
+    T* data() { return _data; }
+    const T* data() const { return _data; }
+    /// @brief Get the number of elements.
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    T* begin() { return _data; }
+    T* end() { return _data + _size; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+    T& operator[](size_t i) { return _data[i]; }
+    const T& operator[](size_t i) const { return _data[i]; }
+
+    /// @brief Get a span of the elements.
+    ShmSpan<T> span() { return ShmSpan<T>(_data, _size); }
+    ShmSpan<const T> span() const { return ShmSpan<const T>(_data, _size); }
+
+    /// @brief Give up the typed view and get the buffer back, e.g. to publish it as ``Bytes``.
+    ZShmMut release() && { return std::move(_buf); }
+
+   private:
+    ZShmMut _buf;
+    T* _data = nullptr;
+    size_t _size = 0;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A single trivially copyable ``T`` owning a mutable SHM buffer, to be filled and then published without
+/// copies.
+///
+/// The object is default-initialized: its value is whatever the buffer contains until it is written.
+template <class T>
+class ShmObject {
+    static_assert(std::is_trivially_copyable_v<T>, "ShmObject requires a trivially copyable type");
+
+   public:
+    /// @name Constructors
+
+    /// @brief Create an object over a buffer.
+    /// @param buf buffer aligned for ``T``, of exactly ``sizeof(T)`` bytes, e.g. allocated from a layout created by
+    /// ``ShmObject::create_layout``.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    ShmObject(ZShmMut&& buf, ZResult* err = nullptr) : _buf(std::move(buf)) {
+        ZResult res = detail::check_typed_buffer<T>(_buf.data(), _buf.len(), 1);
+        if (res == Z_OK && _buf.len() != sizeof(T)) res = Z_EINVAL;
+        __ZENOH_RESULT_CHECK(res, err, "Failed to create ShmObject: the buffer is misaligned or has a wrong size");
+        if (res != Z_OK) return;
+        _data = detail::construct_typed_buffer<T>(_buf.data(), 1);
+    }
+
+    /// @name Methods
+
+    /// @brief Create a layout allocating buffers for ``T``.
+    /// @param provider the provider to allocate from.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    static AllocLayout create_layout(const ShmProvider& provider, ZResult* err = nullptr) {
+        return AllocLayout(provider, sizeof(T), detail::typed_alignment<T>(), err);
+    }
+
+    /// @brief Create an object from the result of an allocation, e.g. ``ShmObject<Pose>::from(layout.alloc_gc())``.
+    /// @return the object or the allocation error.
+    static std::variant<ShmObject, AllocError> from(BufAllocResult&& result) {
+        if (auto* error = std::get_if<AllocError>(&result)) return *error;
+        return ShmObject(std::get<ZShmMut>(std::move(result)));
+    }
+
+    T& get() { return *_data; }
+    const T& get() const { return *_data; }
+    T& operator*() { return *_data; }
+    const T& operator*() const { return *_data; }
+    T* operator->() { return _data; }
+    const T* operator->() const { return _data; }
+
+    /// @brief Give up the typed view and get the buffer back, e.g. to publish it as ``Bytes``.
+    ZShmMut release() && { return std::move(_buf); }
+
+   private:
+    ZShmMut _buf;
+    T* _data = nullptr;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A read-only view of an array of trivially copyable ``T`` in a received SHM buffer.
+///
+/// The view keeps a reference to the buffer, which stays valid as long as the view exists. A single object is viewed
+/// as an array of one element.
+template <class T>
+class ShmArrayView {
+    static_assert(std::is_trivially_copyable_v<T>, "ShmArrayView requires a trivially copyable type");
+
+   public:
+    /// @name Constructors
+
+    /// @brief Create a view of a SHM buffer.
+    /// @param shm buffer aligned for ``T``, whose length is a multiple of ``sizeof(T)``.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    ShmArrayView(ZShm&& shm, ZResult* err = nullptr) : _shm(std::move(shm)) {
+        ZResult res = Z_EINVAL;
+        if (interop::detail::check(_shm)) res = detail::check_typed_buffer<T>(_shm.data(), _shm.len(), 0);
+        __ZENOH_RESULT_CHECK(res, err,
+                             "Failed to create ShmArrayView: the buffer is misaligned or has a partial element");
+        if (res != Z_OK) return;
+        _size = _shm.len() / sizeof(T);
+        _data = reinterpret_cast<const T*>(_shm.data());
+    }
+
+    /// @brief Create a view of a payload, which must be a single SHM buffer, see ``Bytes::as_shm``.
+    /// @param bytes the payload.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    ShmArrayView(const Bytes& bytes, ZResult* err = nullptr) : ShmArrayView(bytes.as_shm(err), err) {}
+
+    /// @name Methods
+
+    const T* data() const { return _data; }
+    /// @brief Get the number of elements.
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+    const T& operator[](size_t i) const { return _data[i]; }
+
+    /// @brief Get a span of the elements.
+    ShmSpan<const T> span() const { return ShmSpan<const T>(_data, _size); }
+
+    /// @brief Get the underlying buffer.
+    const ZShm& shm() const { return _shm; }
+
+   private:
+    ZShm _shm;
+    const T* _data = nullptr;
+    size_t _size = 0;
+};
+
+}  // end of namespace zenoh
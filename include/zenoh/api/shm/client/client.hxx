@@ -14,5 +14,6 @@
 
 #pragma once
 
+#include "segment_cache.hxx"
 #include "shm_client.hxx"
 #include "shm_segment.hxx"
\ No newline at end of file
@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "../common/types.hxx"
+#include "../provider/stats.hxx"
+#include "shm_client.hxx"
+#include "shm_segment.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A cache of the segments attached by a ``CppShmClient``, see ``ShmSegmentCache::make_client``.
+///
+/// Segments can be attached ahead of the first buffer received from them with ``prefetch``, e.g. when a new producer
+/// is discovered through a liveliness token carrying the id of its segment. Segments which are not in use by Zenoh
+/// are kept mapped in least recently used order, and unmapped once the cache exceeds its budget. Segments in use are
+/// never unmapped, and attaching a segment never fails because of the budget. Segments are attached without holding
+/// the lock of the cache, so a slow attach does not block the other segments.
+class ShmSegmentCache {
+   public:
+    /// @brief Options to be passed when constructing ``ShmSegmentCache``.
+    struct ShmSegmentCacheOptions {
+        /// @name Fields
+
+        /// @brief Maximum address space of the mapped segments, in bytes. Segments whose size is unknown, see
+        /// ``CppShmSegment::size``, only count in ``max_segments``.
+        size_t max_bytes = SIZE_MAX;
+        /// @brief Maximum number of mapped segments.
+        size_t max_segments = SIZE_MAX;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmSegmentCacheOptions create_default() { return {}; }
+    };
+
+    /// @brief Statistics of the cache.
+    struct Stats {
+        /// @brief Number of segments requested by Zenoh which were already mapped.
+        uint64_t hits = 0;
+        /// @brief Number of segments requested by Zenoh which had to be attached.
+        uint64_t misses = 0;
+        /// @brief Number of segments attached by ``prefetch``.
+        uint64_t prefetched = 0;
+        /// @brief Number of attaches which failed.
+        uint64_t failures = 0;
+        /// @brief Number of segments unmapped to stay within the budget.
+        uint64_t evictions = 0;
+        /// @brief Number of mapped segments.
+        size_t segments = 0;
+        /// @brief Address space of the mapped segments, as far as it is known.
+        size_t bytes = 0;
+        /// @brief Latencies of the successful attaches of the underlying client.
+        ShmLatencyHistogram attach_latency;
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new cache of the segments of a client. Use ``make_client`` to get a ``ShmClient`` reading
+    /// through the cache.
+    /// @param client the client attaching the segments.
+    /// @param options options of the cache.
+    ShmSegmentCache(std::unique_ptr<CppShmClient>&& client,
+                    ShmSegmentCacheOptions&& options = ShmSegmentCacheOptions::create_default())
+        : _client(std::move(client)), _options(std::move(options)) {}
+
+    ShmSegmentCache(const ShmSegmentCache&) = delete;
+    ShmSegmentCache& operator=(const ShmSegmentCache&) = delete;
+
+    /// @brief Create a SHM client caching the segments attached by another one.
+    /// @param client the client attaching the segments, e.g. ``MemfdShmClient::Client``.
+    /// @param options options of the cache.
+    /// @return the client, to be handed to ``ShmClientStorage``, and the cache it shares, to prefetch segments and
+    /// read the statistics.
+    static std::pair<ShmClient, std::shared_ptr<ShmSegmentCache>> make_client(
+        std::unique_ptr<CppShmClient>&& client,
+        ShmSegmentCacheOptions&& options = ShmSegmentCacheOptions::create_default()) {
+        auto cache = std::make_shared<ShmSegmentCache>(std::move(client), std::move(options));
+        return {ShmClient(std::make_unique<Client>(cache)), cache};
+    }
+
+    /// @name Methods
+
+    /// @brief Attach a segment ahead of its first use, if it is not mapped yet. The segment may be unmapped again if
+    /// the budget is exceeded before it is used.
+    /// @param segment_id the id of the segment.
+    /// @return true if the segment is mapped.
+    bool prefetch(SegmentId segment_id) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(segment_id);
+            if (it != _entries.end()) {
+                if (it->second.users == 0) touch(it->second);
+                return true;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        // Declared before the lock, so that a segment attached concurrently by another thread is unmapped after it.
+        std::unique_ptr<CppShmSegment> segment = _client->attach(segment_id);
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto [entry, inserted] = insert(segment_id, segment, start);
+        if (entry == nullptr) return false;
+        if (!inserted) {
+            if (entry->users == 0) touch(*entry);
+            return true;
+        }
+        _stats.prefetched++;
+        _lru.push_front(segment_id);
+        entry->lru = _lru.begin();
+        evict();
+        return _entries.count(segment_id) != 0;
+    }
+
+    /// @brief Check if a segment is mapped.
+    bool contains(SegmentId segment_id) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.count(segment_id) != 0;
+    }
+
+    /// @brief Get the statistics of the cache.
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats out = _stats;
+        out.segments = _entries.size();
+        out.bytes = _bytes;
+        return out;
+    }
+
+   private:
+    struct Entry {
+        std::shared_ptr<CppShmSegment> segment;
+        size_t size = 0;
+        size_t users = 0;
+        std::list<SegmentId>::iterator lru;
+    };
+
+    // The client handed to Zenoh, attaching the segments through the cache.
+    class Client : public CppShmClient {
+       public:
+        Client(std::shared_ptr<ShmSegmentCache> cache) : _cache(std::move(cache)) {}
+
+        std::unique_ptr<CppShmSegment> attach(SegmentId segment_id) override {
+            return _cache->attach(segment_id, _cache);
+        }
+
+       private:
+        std::shared_ptr<ShmSegmentCache> _cache;
+    };
+
+    // The segment handed to Zenoh, which returns the mapping to the cache when dropped.
+    class Segment : public CppShmSegment {
+       public:
+        Segment(std::shared_ptr<ShmSegmentCache> cache, SegmentId id, std::shared_ptr<CppShmSegment> segment)
+            : _cache(std::move(cache)), _id(id), _segment(std::move(segment)) {}
+
+        ~Segment() override { _cache->release(_id); }
+
+        uint8_t* map(z_chunk_id_t chunk_id) override { return _segment->map(chunk_id); }
+        size_t size() const override { return _segment->size(); }
+
+       private:
+        std::shared_ptr<ShmSegmentCache> _cache;
+        SegmentId _id;
+        std::shared_ptr<CppShmSegment> _segment;
+    };
+
+    // Gets the segment ``segment_id`` for Zenoh, attaching it if needed.
+    std::unique_ptr<CppShmSegment> attach(SegmentId segment_id, const std::shared_ptr<ShmSegmentCache>& self) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(segment_id);
+            if (it != _entries.end()) {
+                _stats.hits++;
+                return use(segment_id, it->second, self);
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        // Declared before the lock, so that a segment attached concurrently by another thread is unmapped after it.
+        std::unique_ptr<CppShmSegment> segment = _client->attach(segment_id);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.misses++;
+        Entry* entry = insert(segment_id, segment, start).first;
+        if (entry == nullptr) return nullptr;
+        return use(segment_id, *entry, self);
+    }
+
+    // Hands a mapped segment to Zenoh.
+    std::unique_ptr<CppShmSegment> use(SegmentId segment_id, Entry& entry,
+                                       const std::shared_ptr<ShmSegmentCache>& self) {
+        if (entry.users == 0 && entry.lru != _lru.end()) _lru.erase(entry.lru);
+        entry.lru = _lru.end();
+        entry.users++;
+        auto segment = std::make_unique<Segment>(self, segment_id, entry.segment);
+        evict();
+        return segment;
+    }
+
+    // Inserts a segment attached since ``start``, unless another thread inserted it meanwhile: ``segment`` is then
+    // left to the caller, and the existing entry is returned. Returns a null entry if the attach failed.
+    std::pair<Entry*, bool> insert(SegmentId segment_id, std::unique_ptr<CppShmSegment>& segment,
+                                   std::chrono::steady_clock::time_point start) {
+        if (segment == nullptr) {
+            _stats.failures++;
+            return {nullptr, false};
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        _stats.attach_latency.counts[ShmLatencyHistogram::bucket(latency)]++;
+        auto [it, inserted] = _entries.try_emplace(segment_id);
+        if (!inserted) return {&it->second, false};
+        Entry& entry = it->second;
+        entry.size = segment->size();
+        entry.segment = std::move(segment);
+        entry.lru = _lru.end();
+        _bytes += entry.size;
+        return {&entry, true};
+    }
+
+    void release(SegmentId segment_id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(segment_id);
+        if (it == _entries.end() || --it->second.users > 0) return;
+        _lru.push_front(segment_id);
+        it->second.lru = _lru.begin();
+        evict();
+    }
+
+    void touch(Entry& entry) {
+        _lru.splice(_lru.begin(), _lru, entry.lru);
+        entry.lru = _lru.begin();
+    }
+
+    // Unmaps the least recently used segments not in use until the cache is within its budget.
+    void evict() {
+        while (!_lru.empty() && (_bytes > _options.max_bytes || _entries.size() > _options.max_segments)) {
+            auto it = _entries.find(_lru.back());
+            _lru.pop_back();
+            _bytes -= it->second.size;
+            _entries.erase(it);
+            _stats.evictions++;
+        }
+    }
+
+    std::unique_ptr<CppShmClient> _client;
+    ShmSegmentCacheOptions _options;
+    mutable std::mutex _mutex;
+    std::unordered_map<SegmentId, Entry> _entries;
+    // Segments not in use, the most recently used first.
+    std::list<SegmentId> _lru;
+    size_t _bytes = 0;
+    Stats _stats;
+};
+
+}  // end of namespace zenoh
@@ -21,6 +21,9 @@ namespace zenoh {
 class CppShmSegment {
    public:
     virtual uint8_t* map(z_chunk_id_t chunk_id) = 0;
+    /// @brief Get the size of the address space used by the segment, or 0 if unknown. Used by ``ShmSegmentCache`` to
+    /// enforce its budget.
+    virtual size_t size() const { return 0; }
     virtual ~CppShmSegment() = default;
 };
 
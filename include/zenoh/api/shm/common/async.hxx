@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define ZENOHCXX_SHM_COROUTINES
+#endif
+
+namespace zenoh::detail {
+
+/// Calls ``f`` with the result of an asynchronous allocation. If the allocation is dropped without a result, e.g.
+/// because it could not be started, ``f`` is called with ``error`` instead, so that waiters are never left hanging.
+/// ``f`` is called from Zenoh threads or from a destructor, where exceptions can not propagate: an exception thrown
+/// by ``f`` is discarded.
+template <class Base, class Result, class F>
+class ShmAsyncCallback : public Base {
+   public:
+    ShmAsyncCallback(F&& f, Result&& error) : _f(std::move(f)), _error(std::move(error)) {}
+
+    ~ShmAsyncCallback() override {
+        if (_error.has_value()) call(std::move(*_error));
+    }
+
+   private:
+    void on_result(Result&& result) override {
+        _error.reset();
+        call(std::move(result));
+    }
+
+    void call(Result&& result) noexcept {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+        try {
+            _f(std::move(result));
+        } catch (...) {
+        }
+#else
+        _f(std::move(result));
+#endif
+    }
+
+    F _f;
+    std::optional<Result> _error;
+};
+
+#ifdef ZENOHCXX_SHM_COROUTINES
+/// Awaiter of an asynchronous allocation started by ``launch(callback)``. The awaiting coroutine is resumed on the
+/// thread delivering the result.
+template <class Result, class Launch>
+class ShmAllocAwaiter {
+   public:
+    ShmAllocAwaiter(Launch&& launch) : _launch(std::move(launch)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // The awaiter may be destroyed as soon as the coroutine is resumed, possibly before ``launch`` returns.
+        Launch launch = std::move(_launch);
+        launch([this, handle](Result&& result) {
+            _result.emplace(std::move(result));
+            handle.resume();
+        });
+    }
+
+    Result await_resume() { return std::move(*_result); }
+
+   private:
+    Launch _launch;
+    std::optional<Result> _result;
+};
+#endif
+
+}  // namespace zenoh::detail
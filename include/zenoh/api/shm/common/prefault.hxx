@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "../../base.hxx"
+
+namespace zenoh::detail {
+
+inline size_t memory_page_size() {
+#if defined(__unix__) || defined(__APPLE__)
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+#else
+    return 4096;
+#endif
+}
+
+/// Touches every page of a range so that the page faults happen now rather than on first use. Pages are written
+/// with their current content if ``write`` is true, so that a writable mapping does not fault again on first write.
+/// The range does not need to be page aligned: the pages it starts and ends in are touched at their first byte within
+/// the range, so that no byte outside of it is accessed.
+inline void prefault_memory(uint8_t* data, size_t len, bool write) {
+    if (len == 0) return;
+    const uintptr_t page = memory_page_size();
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    const uintptr_t last = begin + (len - 1);
+    for (uintptr_t page_start = begin - begin % page; page_start <= last; page_start += page) {
+        volatile uint8_t* p = reinterpret_cast<uint8_t*>(std::max(page_start, begin));
+        uint8_t v = *p;
+        if (write) *p = v;
+    }
+}
+
+/// Locks a range in memory, it is unlocked when unmapped. Requires the ``RLIMIT_MEMLOCK`` limit to be large enough
+/// or the ``CAP_IPC_LOCK`` capability.
+inline ZResult lock_memory(uint8_t* data, size_t len) {
+#if defined(__unix__) || defined(__APPLE__)
+    return ::mlock(data, len) == 0 ? Z_OK : Z_EINVAL;
+#else
+    (void)data;
+    (void)len;
+    return Z_EINVAL;
+#endif
+}
+
+}  // namespace zenoh::detail
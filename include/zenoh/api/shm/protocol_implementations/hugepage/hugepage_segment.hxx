@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <sys/vfs.h>
+
+#include <cerrno>
+#include <string>
+
+#include "../mapped_segment.hxx"
+
+namespace zenoh::detail {
+
+constexpr uint32_t HUGETLBFS_MAGIC_NUMBER = 0x958458f6;
+// Rounding of the segments which do not get huge pages, so that transparent huge pages can still back them.
+constexpr size_t DEFAULT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/// Page size of the hugetlbfs file system mounted at ``path``, or 0 if there is none.
+inline size_t hugetlbfs_page_size(const std::string& path) {
+    struct statfs fs;
+    if (::statfs(path.c_str(), &fs) != 0 || static_cast<uint32_t>(fs.f_type) != HUGETLBFS_MAGIC_NUMBER) return 0;
+    return static_cast<size_t>(fs.f_bsize);
+}
+
+inline std::string hugepage_segment_path(const std::string& dir, SegmentId id) {
+    return dir + "/zenoh-hugepage-" + std::to_string(id);
+}
+
+/// Creates a segment file of ``size`` bytes in ``dir`` and maps it with ``flags``, or returns null.
+inline std::unique_ptr<OwnedShmSegment> create_hugepage_segment(const std::string& dir, size_t size, int flags,
+                                                                unsigned int permissions) {
+    for (int attempt = 0; attempt < 16; attempt++) {
+        auto segment = std::make_unique<OwnedShmSegment>();
+        segment->id = random_segment_id();
+        const std::string path = hugepage_segment_path(dir, segment->id);
+        FileDescriptor fd(::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, permissions));
+        if (!fd.valid()) {
+            if (errno == EEXIST) continue;
+            return nullptr;
+        }
+        // From now on the file is unlinked if the segment is dropped.
+        segment->path = path;
+        if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0) return nullptr;
+        if (segment->mapping.map(fd.get(), size, flags) != Z_OK) return nullptr;
+        return segment;
+    }
+    return nullptr;
+}
+
+/// Maps the segment ``id`` created in ``dir`` with ``flags``, or returns an empty mapping.
+inline ShmMapping open_hugepage_segment(const std::string& dir, SegmentId id, int flags) {
+    ShmMapping mapping;
+    FileDescriptor fd(::open(hugepage_segment_path(dir, id).c_str(), O_RDWR | O_CLOEXEC));
+    struct stat st;
+    if (!fd.valid() || ::fstat(fd.get(), &st) != 0 || st.st_size <= 0) return mapping;
+    mapping.map(fd.get(), static_cast<size_t>(st.st_size), flags);
+    return mapping;
+}
+
+/// Asks for transparent huge pages on a mapping which could not get explicit huge pages.
+inline void advise_huge_pages(const ShmMapping& mapping) {
+#if defined(MADV_HUGEPAGE)
+    if (mapping.data() != nullptr) ::madvise(mapping.data(), mapping.size(), MADV_HUGEPAGE);
+#else
+    (void)mapping;
+#endif
+}
+
+}  // namespace zenoh::detail
+
+#endif
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <string>
+
+#include "../../client/shm_client.hxx"
+#include "hugepage_segment.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A SHM client attaching the segments of ``HugePageShmProvider``, to be registered with
+/// ``HugePageShmProvider::PROTOCOL_ID``.
+///
+/// Segments found in the hugetlbfs mount are mapped with ``MAP_HUGETLB``, like on the provider side, and segments
+/// which fell back to regular shared memory are mapped with a transparent huge pages hint. The paths must match the
+/// ones of the providers.
+class HugePageShmClient : public ShmClient {
+   public:
+    /// @brief Options to be passed when constructing ``HugePageShmClient``.
+    struct HugePageShmClientOptions {
+        /// @name Fields
+
+        /// @brief Mount point of the hugetlbfs the providers create their segments in.
+        std::string hugetlbfs_path = "/dev/hugepages";
+        /// @brief Directory the providers create their segments in when huge pages are not available.
+        std::string fallback_path = "/dev/shm";
+        /// @brief If true, the segments are mapped with ``MAP_POPULATE`` when attached, so that reading the first
+        /// buffers of a segment does not page-fault.
+        bool prefault = false;
+        /// @brief If true, the segments are locked in memory with ``mlock`` when attached. Segments which can not be
+        /// locked, e.g. because of ``RLIMIT_MEMLOCK``, are still attached.
+        bool lock = false;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static HugePageShmClientOptions create_default() { return {}; }
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new HugePageShmClient.
+    /// @param options options of the client.
+    HugePageShmClient(HugePageShmClientOptions&& options = HugePageShmClientOptions::create_default())
+        : ShmClient(std::make_unique<Client>(std::move(options))) {}
+
+    /// @brief The ``CppShmClient`` attaching the segments, e.g. to be cached by ``ShmSegmentCache::make_client``.
+    class Client : public CppShmClient {
+       public:
+        Client(HugePageShmClientOptions&& options) : _options(std::move(options)) {}
+
+        std::unique_ptr<CppShmSegment> attach(SegmentId segment_id) override {
+            const int flags = _options.prefault ? MAP_POPULATE : 0;
+            auto mapping = detail::open_hugepage_segment(_options.hugetlbfs_path, segment_id, flags | MAP_HUGETLB);
+            if (mapping.data() == nullptr) {
+                mapping = detail::open_hugepage_segment(_options.fallback_path, segment_id, flags);
+                detail::advise_huge_pages(mapping);
+            }
+            if (mapping.data() == nullptr) return nullptr;
+            if (_options.lock) detail::lock_memory(mapping.data(), mapping.size());
+            return std::make_unique<detail::MappedShmSegment>(std::move(mapping));
+        }
+
+       private:
+        HugePageShmClientOptions _options;
+    };
+};
+
+}  // end of namespace zenoh
+
+#endif
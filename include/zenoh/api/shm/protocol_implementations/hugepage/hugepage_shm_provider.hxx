@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <string>
+
+#include "../../provider/shm_provider.hxx"
+#include "hugepage_segment.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A SHM provider whose segment is backed by huge pages, to be paired with ``HugePageShmClient``.
+///
+/// The segment is a file created in a hugetlbfs mount and mapped with ``MAP_HUGETLB``, so that producers and
+/// consumers of large buffers (e.g. video frames) need a fraction of the TLB entries and page faults of regular
+/// pages. If no hugetlbfs is mounted at the configured path, or if there are not enough free huge pages, the segment
+/// falls back to a regular shared memory file, on which transparent huge pages are requested with ``madvise``.
+///
+/// Allocations are served by a TLSF allocator (see ``TlsfShmProviderBackend``). The provider is available on Linux
+/// only.
+class HugePageShmProvider : public ShmProvider {
+   public:
+    /// @brief Protocol id of the provider, to register ``HugePageShmClient`` with in ``ShmClientStorage``.
+    static constexpr ProtocolId PROTOCOL_ID = 0x48554745;
+
+    /// @brief Options to be passed when constructing ``HugePageShmProvider``.
+    struct HugePageShmProviderOptions {
+        /// @name Fields
+
+        /// @brief Mount point of the hugetlbfs to create the segment in.
+        std::string hugetlbfs_path = "/dev/hugepages";
+        /// @brief Directory to create the segment in when huge pages are not available, usually a tmpfs.
+        std::string fallback_path = "/dev/shm";
+        /// @brief If false, the provider creation fails when huge pages are not available.
+        bool allow_fallback = true;
+        /// @brief Access permissions of the segment file.
+        unsigned int permissions = 0600;
+        /// @brief log2 of the alignment of the allocated buffers, at least 5.
+        uint8_t alignment_pow = 6;
+        /// @brief If true, the segment is mapped with ``MAP_POPULATE``, so that the first writes to the buffers do not
+        /// page-fault.
+        bool prefault = false;
+        /// @brief If true, the segment is locked in memory with ``mlock``. Requires a large enough ``RLIMIT_MEMLOCK``
+        /// or the ``CAP_IPC_LOCK`` capability, the provider creation fails otherwise.
+        bool lock = false;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static HugePageShmProviderOptions create_default() { return {}; }
+    };
+
+    using ShmProvider::ShmProvider;
+
+    /// @name Constructors
+
+    /// @brief Create a new HugePageShmProvider.
+    /// @param size size of the segment, rounded up to a multiple of the huge page size. The allocator keeps a small
+    /// header in front of every buffer.
+    /// @param options options of the provider.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    HugePageShmProvider(size_t size,
+                        HugePageShmProviderOptions&& options = HugePageShmProviderOptions::create_default(),
+                        ZResult* err = nullptr)
+        : ShmProvider(zenoh::detail::null_object) {
+        std::unique_ptr<detail::OwnedShmSegment> segment;
+        const int flags = options.prefault ? MAP_POPULATE : 0;
+        if (size_t page = detail::hugetlbfs_page_size(options.hugetlbfs_path); page > 0) {
+            segment = detail::create_hugepage_segment(options.hugetlbfs_path, detail::round_up(size, page),
+                                                      flags | MAP_HUGETLB, options.permissions);
+            _huge_pages = segment != nullptr;
+        }
+        if (segment == nullptr && options.allow_fallback) {
+            segment = detail::create_hugepage_segment(options.fallback_path,
+                                                      detail::round_up(size, detail::DEFAULT_HUGE_PAGE_SIZE), flags,
+                                                      options.permissions);
+            if (segment != nullptr) detail::advise_huge_pages(segment->mapping);
+        }
+        if (segment == nullptr) {
+            __ZENOH_RESULT_CHECK(Z_EINVAL, err, "Failed to create huge page SHM provider: can not create the segment");
+            return;
+        }
+        if (options.lock && detail::lock_memory(segment->mapping.data(), segment->mapping.size()) != Z_OK) {
+            __ZENOH_RESULT_CHECK(Z_EINVAL, err,
+                                 "Failed to create huge page SHM provider: can not lock the segment in memory");
+            return;
+        }
+        _segment_id = segment->id;
+        ZResult res = Z_OK;
+        auto backend = std::make_unique<detail::MappedShmProviderBackend>(std::move(segment), options.alignment_pow,
+                                                                           &res);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to create huge page SHM provider: incorrect size or alignment");
+        if (res != Z_OK) return;
+        ShmProvider::operator=(CppShmProvider(PROTOCOL_ID, std::unique_ptr<CppShmProviderBackendThreadsafe>(
+                                                               std::move(backend))));
+    }
+
+    /// @name Methods
+
+    /// @brief Check if the segment is backed by explicit huge pages, rather than by the fallback.
+    bool uses_huge_pages() const { return _huge_pages; }
+
+    /// @brief Get the id of the segment of the provider.
+    SegmentId segment_id() const { return _segment_id; }
+
+   private:
+    bool _huge_pages = false;
+    SegmentId _segment_id = 0;
+};
+
+}  // end of namespace zenoh
+
+#endif
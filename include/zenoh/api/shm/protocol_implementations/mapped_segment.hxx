@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "../../base.hxx"
+#include "../client/shm_client.hxx"
+#include "../common/prefault.hxx"
+#include "../common/types.hxx"
+#include "../provider/shm_provider_backend.hxx"
+#include "../provider/tlsf_shm_provider_backend.hxx"
+
+namespace zenoh::detail {
+
+/// An owned shared mapping of a file.
+class ShmMapping {
+   public:
+    ShmMapping() = default;
+    ShmMapping(const ShmMapping&) = delete;
+    ShmMapping& operator=(const ShmMapping&) = delete;
+    ShmMapping(ShmMapping&& other) : _data(std::exchange(other._data, nullptr)), _len(std::exchange(other._len, 0)) {}
+    ShmMapping& operator=(ShmMapping&& other) {
+        if (this != &other) {
+            reset();
+            _data = std::exchange(other._data, nullptr);
+            _len = std::exchange(other._len, 0);
+        }
+        return *this;
+    }
+    ~ShmMapping() { reset(); }
+
+    /// Maps the first ``len`` bytes of ``fd`` for reading and writing, ``flags`` are added to ``MAP_SHARED``.
+    ZResult map(int fd, size_t len, int flags) {
+        reset();
+        void* data = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED | flags, fd, 0);
+        if (data == MAP_FAILED) return Z_EINVAL;
+        _data = static_cast<uint8_t*>(data);
+        _len = len;
+        return Z_OK;
+    }
+
+    void reset() {
+        if (_data != nullptr) ::munmap(_data, _len);
+        _data = nullptr;
+        _len = 0;
+    }
+
+    uint8_t* data() const { return _data; }
+    size_t size() const { return _len; }
+
+    /// Address of the chunk at offset ``chunk``, or null if it is out of the mapping.
+    uint8_t* at(z_chunk_id_t chunk) const { return chunk < _len ? _data + chunk : nullptr; }
+
+   private:
+    uint8_t* _data = nullptr;
+    size_t _len = 0;
+};
+
+/// An owned file descriptor.
+class FileDescriptor {
+   public:
+    explicit FileDescriptor(int fd = -1) : _fd(fd) {}
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    FileDescriptor(FileDescriptor&& other) : _fd(std::exchange(other._fd, -1)) {}
+    FileDescriptor& operator=(FileDescriptor&& other) {
+        if (this != &other) {
+            reset();
+            _fd = std::exchange(other._fd, -1);
+        }
+        return *this;
+    }
+    ~FileDescriptor() { reset(); }
+
+    void reset() {
+        if (_fd >= 0) ::close(_fd);
+        _fd = -1;
+    }
+
+    int get() const { return _fd; }
+    bool valid() const { return _fd >= 0; }
+
+   private:
+    int _fd;
+};
+
+/// A shared memory segment created by a provider, released once the provider is dropped. Protocols keeping more
+/// state alive with the segment derive from it.
+struct OwnedShmSegment {
+    SegmentId id = 0;
+    ShmMapping mapping;
+    /// Path of the file of the segment, unlinked on destruction if not empty.
+    std::string path;
+
+    OwnedShmSegment() = default;
+    OwnedShmSegment(const OwnedShmSegment&) = delete;
+    OwnedShmSegment& operator=(const OwnedShmSegment&) = delete;
+    virtual ~OwnedShmSegment() {
+        mapping.reset();
+        if (!path.empty()) ::unlink(path.c_str());
+    }
+};
+
+/// Random id for a new segment, the callers retry on collisions.
+inline SegmentId random_segment_id() {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    return static_cast<SegmentId>(rng());
+}
+
+inline size_t round_up(size_t size, size_t granularity) { return (size + granularity - 1) / granularity * granularity; }
+
+/// A provider backend managing an ``OwnedShmSegment`` with a TLSF allocator: the chunk ids are the offsets of the
+/// chunks in the segment, as expected by ``MappedShmSegment``.
+class MappedShmProviderBackend : public CppShmProviderBackendThreadsafe {
+   public:
+    MappedShmProviderBackend(std::unique_ptr<OwnedShmSegment> segment, uint8_t alignment_pow, ZResult* err)
+        : _segment(std::move(segment)),
+          _backend(_segment->mapping.data(), _segment->mapping.size(), _segment->id, alignment_pow, err) {}
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) override { return _backend.alloc(layout); }
+    void free(const ChunkDescriptor& chunk) override { _backend.free(chunk); }
+    size_t defragment() override { return _backend.defragment(); }
+    size_t available() const override { return _backend.available(); }
+    std::optional<ShmOccupancy> occupancy() const override { return _backend.occupancy(); }
+    void layout_for(MemoryLayout& layout) override { _backend.layout_for(layout); }
+
+    TlsfStats stats() const { return _backend.stats(); }
+    const OwnedShmSegment& segment() const { return *_segment; }
+
+   private:
+    std::unique_ptr<OwnedShmSegment> _segment;
+    TlsfShmProviderBackendThreadsafe _backend;
+};
+
+/// A segment attached by a client: chunk ids are offsets in the mapping.
+class MappedShmSegment : public CppShmSegment {
+   public:
+    explicit MappedShmSegment(ShmMapping&& mapping) : _mapping(std::move(mapping)) {}
+
+    uint8_t* map(z_chunk_id_t chunk_id) override { return _mapping.at(chunk_id); }
+
+    size_t size() const override { return _mapping.size(); }
+
+   private:
+    ShmMapping _mapping;
+};
+
+}  // namespace zenoh::detail
+
+#endif
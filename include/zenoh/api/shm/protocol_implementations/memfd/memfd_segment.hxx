@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "../mapped_segment.hxx"
+
+namespace zenoh::detail {
+
+/// Name of the rendezvous socket of a memfd segment in the abstract socket namespace: it disappears with the last
+/// descriptor of the socket, e.g. when the process crashes.
+inline socklen_t memfd_rendezvous_address(SegmentId id, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    const std::string name = "zenoh-memfd/" + std::to_string(::geteuid()) + "/" + std::to_string(id);
+    // The first byte of the path stays 0 for the abstract namespace.
+    std::memcpy(addr.sun_path + 1, name.data(), name.size());
+    return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+}
+
+/// Checks that the peer of a connected socket runs as the same user.
+inline bool memfd_peer_is_same_user(int socket) {
+    ucred cred;
+    socklen_t len = sizeof(cred);
+    return ::getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == ::geteuid();
+}
+
+/// A memfd segment, handed out to the clients of the same user through its rendezvous socket.
+struct MemfdShmSegment : public OwnedShmSegment {
+    FileDescriptor memfd;
+    FileDescriptor listener;
+    std::thread server;
+
+    ~MemfdShmSegment() override {
+        if (server.joinable()) {
+            // Wakes up the blocked accept.
+            ::shutdown(listener.get(), SHUT_RDWR);
+            server.join();
+        }
+    }
+
+    /// Binds the rendezvous socket of the segment, or fails if the id is already in use.
+    bool bind(SegmentId segment_id) {
+        listener = FileDescriptor(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!listener.valid()) return false;
+        sockaddr_un addr;
+        socklen_t len = memfd_rendezvous_address(segment_id, addr);
+        if (::bind(listener.get(), reinterpret_cast<sockaddr*>(&addr), len) != 0 || ::listen(listener.get(), 16) != 0) {
+            const int error = errno;
+            listener.reset();
+            errno = error;
+            return false;
+        }
+        id = segment_id;
+        return true;
+    }
+
+    void serve() {
+        server = std::thread([this]() {
+            while (true) {
+                int conn = ::accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC);
+                if (conn < 0) {
+                    if (errno == EINTR || errno == ECONNABORTED) continue;
+                    return;
+                }
+                FileDescriptor peer(conn);
+                if (memfd_peer_is_same_user(peer.get())) send_fd(peer.get());
+            }
+        });
+    }
+
+   private:
+    void send_fd(int socket) const {
+        char data = 0;
+        iovec iov = {&data, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        const int fd = memfd.get();
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+        ::sendmsg(socket, &msg, MSG_NOSIGNAL);
+    }
+};
+
+/// Creates a memfd segment of ``size`` bytes mapped with ``flags``, and starts serving it, or returns null.
+inline std::unique_ptr<MemfdShmSegment> create_memfd_segment(size_t size, bool huge_pages, bool seal, int flags) {
+    auto segment = std::make_unique<MemfdShmSegment>();
+    unsigned int memfd_flags = MFD_CLOEXEC | (seal ? MFD_ALLOW_SEALING : 0) | (huge_pages ? MFD_HUGETLB : 0);
+    segment->memfd = FileDescriptor(::memfd_create("zenoh-shm", memfd_flags));
+    if (!segment->memfd.valid() || ::ftruncate(segment->memfd.get(), static_cast<off_t>(size)) != 0) return nullptr;
+    if (seal && ::fcntl(segment->memfd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        return nullptr;
+    }
+    if (segment->mapping.map(segment->memfd.get(), size, flags) != Z_OK) return nullptr;
+    for (int attempt = 0;; attempt++) {
+        if (segment->bind(random_segment_id())) break;
+        if (errno != EADDRINUSE || attempt == 16) return nullptr;
+    }
+    segment->serve();
+    return segment;
+}
+
+/// Receives the memfd of the segment ``id`` from its rendezvous socket, or returns an invalid descriptor.
+inline FileDescriptor receive_memfd(SegmentId id) {
+    FileDescriptor socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    sockaddr_un addr;
+    socklen_t len = memfd_rendezvous_address(id, addr);
+    if (!socket.valid() || ::connect(socket.get(), reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+        !memfd_peer_is_same_user(socket.get())) {
+        return FileDescriptor();
+    }
+    char data;
+    iovec iov = {&data, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t received;
+    do {
+        received = ::recvmsg(socket.get(), &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (received <= 0 || cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        return FileDescriptor();
+    }
+    int fd;
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return FileDescriptor(fd);
+}
+
+/// Maps the segment ``id`` with ``flags``, or returns an empty mapping. Unsealed segments are rejected if
+/// ``require_seals`` is true, as their owner could shrink them under the mapping.
+inline ShmMapping open_memfd_segment(SegmentId id, int flags, bool require_seals) {
+    ShmMapping mapping;
+    FileDescriptor fd = receive_memfd(id);
+    struct stat st;
+    if (!fd.valid() || ::fstat(fd.get(), &st) != 0 || st.st_size <= 0) return mapping;
+    if (require_seals) {
+        const int seals = ::fcntl(fd.get(), F_GET_SEALS);
+        if (seals < 0 || (seals & F_SEAL_SHRINK) == 0) return mapping;
+    }
+    mapping.map(fd.get(), static_cast<size_t>(st.st_size), flags);
+    return mapping;
+}
+
+}  // namespace zenoh::detail
+
+#endif
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include "../../client/shm_client.hxx"
+#include "memfd_segment.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A SHM client attaching the segments of ``MemfdShmProvider``, to be registered with
+/// ``MemfdShmProvider::PROTOCOL_ID``.
+///
+/// The memfd of a segment is received from the rendezvous socket of its provider, which only serves processes of the
+/// same user, and is closed as soon as it is mapped.
+class MemfdShmClient : public ShmClient {
+   public:
+    /// @brief Options to be passed when constructing ``MemfdShmClient``.
+    struct MemfdShmClientOptions {
+        /// @name Fields
+
+        /// @brief If true, segments whose size is not sealed are not attached.
+        bool require_seals = false;
+        /// @brief If true, the segments are mapped with ``MAP_POPULATE`` when attached, so that reading the first
+        /// buffers of a segment does not page-fault.
+        bool prefault = false;
+        /// @brief If true, the segments are locked in memory with ``mlock`` when attached. Segments which can not be
+        /// locked, e.g. because of ``RLIMIT_MEMLOCK``, are still attached.
+        bool lock = false;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static MemfdShmClientOptions create_default() { return {}; }
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new MemfdShmClient.
+    /// @param options options of the client.
+    MemfdShmClient(MemfdShmClientOptions&& options = MemfdShmClientOptions::create_default())
+        : ShmClient(std::make_unique<Client>(std::move(options))) {}
+
+    /// @brief The ``CppShmClient`` attaching the segments, e.g. to be cached by ``ShmSegmentCache::make_client``.
+    class Client : public CppShmClient {
+       public:
+        Client(MemfdShmClientOptions&& options) : _options(std::move(options)) {}
+
+        std::unique_ptr<CppShmSegment> attach(SegmentId segment_id) override {
+            auto mapping = detail::open_memfd_segment(segment_id, _options.prefault ? MAP_POPULATE : 0,
+                                                      _options.require_seals);
+            if (mapping.data() == nullptr) return nullptr;
+            if (_options.lock) detail::lock_memory(mapping.data(), mapping.size());
+            return std::make_unique<detail::MappedShmSegment>(std::move(mapping));
+        }
+
+       private:
+        MemfdShmClientOptions _options;
+    };
+};
+
+}  // end of namespace zenoh
+
+#endif
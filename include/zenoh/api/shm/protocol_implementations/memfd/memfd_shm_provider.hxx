@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if defined(__linux__)
+
+#include "../../provider/shm_provider.hxx"
+#include "../hugepage/hugepage_segment.hxx"
+#include "memfd_segment.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A SHM provider whose segment is an anonymous memfd, to be paired with ``MemfdShmClient``.
+///
+/// Unlike ``PosixShmProvider``, the segment has no name in the file system: clients of the same user get its file
+/// descriptor from a rendezvous socket of the provider, in the abstract socket namespace. Both the memfd and the
+/// socket vanish with the process, so a crash leaves nothing behind and ``cleanup_orphaned_shm_segments`` is not
+/// needed. The segment can be sealed against resizing, so that clients can not make the provider fault by shrinking
+/// it.
+///
+/// Clients must share the network namespace of the provider to reach its rendezvous socket. Allocations are served
+/// by a TLSF allocator (see ``TlsfShmProviderBackend``). The provider is available on Linux only.
+class MemfdShmProvider : public ShmProvider {
+   public:
+    /// @brief Protocol id of the provider, to register ``MemfdShmClient`` with in ``ShmClientStorage``.
+    static constexpr ProtocolId PROTOCOL_ID = 0x4D454D46;
+
+    /// @brief Options to be passed when constructing ``MemfdShmProvider``.
+    struct MemfdShmProviderOptions {
+        /// @name Fields
+
+        /// @brief If true, the size of the segment is sealed.
+        bool seal = true;
+        /// @brief If true, the segment is backed by huge pages if there are enough free ones, and by regular pages
+        /// otherwise. The size of the segment is then rounded up to 2 MiB.
+        bool huge_pages = false;
+        /// @brief If true, the segment is mapped with ``MAP_POPULATE``, so that the first writes to the buffers do not
+        /// page-fault.
+        bool prefault = false;
+        /// @brief If true, the segment is locked in memory with ``mlock``. Requires a large enough ``RLIMIT_MEMLOCK``
+        /// or the ``CAP_IPC_LOCK`` capability, the provider creation fails otherwise.
+        bool lock = false;
+        /// @brief log2 of the alignment of the allocated buffers, at least 5.
+        uint8_t alignment_pow = 6;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static MemfdShmProviderOptions create_default() { return {}; }
+    };
+
+    using ShmProvider::ShmProvider;
+
+    /// @name Constructors
+
+    /// @brief Create a new MemfdShmProvider.
+    /// @param size size of the segment. The allocator keeps a small header in front of every buffer.
+    /// @param options options of the provider.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    MemfdShmProvider(size_t size, MemfdShmProviderOptions&& options = MemfdShmProviderOptions::create_default(),
+                     ZResult* err = nullptr)
+        : ShmProvider(zenoh::detail::null_object) {
+        std::unique_ptr<detail::MemfdShmSegment> segment;
+        const int flags = options.prefault ? MAP_POPULATE : 0;
+        if (options.huge_pages) {
+            size = detail::round_up(size, detail::DEFAULT_HUGE_PAGE_SIZE);
+            segment = detail::create_memfd_segment(size, true, options.seal, flags);
+            _huge_pages = segment != nullptr;
+        }
+        if (segment == nullptr) {
+            segment = detail::create_memfd_segment(size, false, options.seal, flags);
+            if (segment != nullptr && options.huge_pages) detail::advise_huge_pages(segment->mapping);
+        }
+        if (segment == nullptr) {
+            __ZENOH_RESULT_CHECK(Z_EINVAL, err, "Failed to create memfd SHM provider: can not create the segment");
+            return;
+        }
+        if (options.lock && detail::lock_memory(segment->mapping.data(), segment->mapping.size()) != Z_OK) {
+            __ZENOH_RESULT_CHECK(Z_EINVAL, err,
+                                 "Failed to create memfd SHM provider: can not lock the segment in memory");
+            return;
+        }
+        _segment_id = segment->id;
+        ZResult res = Z_OK;
+        auto backend = std::make_unique<detail::MappedShmProviderBackend>(std::move(segment), options.alignment_pow,
+                                                                           &res);
+        __ZENOH_RESULT_CHECK(res, err, "Failed to create memfd SHM provider: incorrect size or alignment");
+        if (res != Z_OK) return;
+        ShmProvider::operator=(CppShmProvider(PROTOCOL_ID, std::unique_ptr<CppShmProviderBackendThreadsafe>(
+                                                               std::move(backend))));
+    }
+
+    /// @name Methods
+
+    /// @brief Check if the segment is backed by huge pages.
+    bool uses_huge_pages() const { return _huge_pages; }
+
+    /// @brief Get the id of the segment of the provider.
+    SegmentId segment_id() const { return _segment_id; }
+
+   private:
+    bool _huge_pages = false;
+    SegmentId _segment_id = 0;
+};
+
+}  // end of namespace zenoh
+
+#endif
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <variant>
+#include <vector>
+
+#include "../../common/prefault.hxx"
 #include "../../provider/shm_provider.hxx"
 
 namespace zenoh {
@@ -22,6 +26,24 @@ namespace zenoh {
 /// @brief An SHM provider implementing zenoh-standard POSIX shared memory protocol
 class PosixShmProvider : public ShmProvider {
    public:
+    /// @brief Options to be passed when constructing ``PosixShmProvider``.
+    struct PosixShmProviderOptions {
+        /// @name Fields
+
+        /// @brief If true, every page of the segment is touched on construction, so that the first writes to the
+        /// buffers do not page-fault.
+        bool prefault = false;
+        /// @brief If true, the segment is locked in memory with ``mlock`` on construction, so that it is never paged
+        /// out. Requires a large enough ``RLIMIT_MEMLOCK`` or the ``CAP_IPC_LOCK`` capability, the provider creation
+        /// fails otherwise. Locking also prefaults the segment.
+        bool lock = false;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static PosixShmProviderOptions create_default() { return {}; }
+    };
+
     using ShmProvider::ShmProvider;
 
     /// @name Constructors
@@ -34,6 +56,40 @@ class PosixShmProvider : public ShmProvider {
         __ZENOH_RESULT_CHECK(::z_posix_shm_provider_new(&this->_0, interop::as_loaned_c_ptr(layout)), err,
                              "Failed to create POSIX SHM provider");
     }
+
+    /// @brief Create a new PosixShmProvider, moving the page-fault cost of the segment to its construction.
+    /// @param layout layout for POSIX shared memory segment to be allocated and used by the provider
+    /// @param options options of the provider.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    PosixShmProvider(const MemoryLayout& layout, PosixShmProviderOptions&& options, ZResult* err = nullptr)
+        : PosixShmProvider(layout, err) {
+        if (!interop::detail::check(*this) || !(options.prefault || options.lock)) return;
+        __ZENOH_RESULT_CHECK(prepare_segment(layout.size(), options.lock), err,
+                             "Failed to create POSIX SHM provider: can not lock the segment in memory");
+    }
+
+   private:
+    // The segment is not exposed by zenoh-c: it is reached by allocating all of it, in buffers as large as possible,
+    // down to single bytes so that the pages holding the tail of the segment are prepared as well. Memory locks are
+    // kept after the buffers are freed, until the segment is unmapped.
+    ZResult prepare_segment(size_t size, bool lock) const {
+        ZResult res = Z_OK;
+        {
+            std::vector<ZShmMut> held;
+            for (size_t chunk = size; chunk > 0 && res == Z_OK; chunk /= 2) {
+                while (res == Z_OK) {
+                    BufLayoutAllocResult alloc = this->alloc(chunk, AllocAlignment({0}));
+                    if (!std::holds_alternative<ZShmMut>(alloc)) break;
+                    ZShmMut& buf = held.emplace_back(std::get<ZShmMut>(std::move(alloc)));
+                    detail::prefault_memory(buf.data(), buf.len(), true);
+                    if (lock) res = detail::lock_memory(buf.data(), buf.len());
+                }
+            }
+        }
+        this->garbage_collect();
+        return res;
+    }
 };
 
 }  // end of namespace zenoh
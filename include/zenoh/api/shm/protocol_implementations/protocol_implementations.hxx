@@ -14,4 +14,6 @@
 
 #pragma once
 
+#include "hugepage/hugepage.hxx"
+#include "memfd/memfd.hxx"
 #include "posix/posix.hxx"
\ No newline at end of file
@@ -16,10 +16,16 @@
 
 #include <memory.h>
 
+#include <future>
+#include <type_traits>
+
 #include "../../base.hxx"
+#include "../common/async.hxx"
 #include "../common/common.hxx"
 #include "chunk.hxx"
+#include "shm_provider.hxx"
 #include "shm_provider_backend.hxx"
+#include "stats.hxx"
 #include "types.hxx"
 #include "types_impl.hxx"
 
@@ -27,6 +33,8 @@ namespace zenoh {
 
 struct AllocLayoutAsyncInterface {
     z_buf_alloc_result_t _result;
+    detail::ShmStatsObserver _observer;
+    detail::ShmStatsCollector::Clock::time_point _start;
     virtual void on_result(BufAllocResult&& result) = 0;
     virtual ~AllocLayoutAsyncInterface() = default;
 };
@@ -36,7 +44,8 @@ namespace shm::provider::closures {
 extern "C" {
 inline void _z_alloc_layout_async_interface_result_fn(void* context, struct z_buf_alloc_result_t* result) {
     auto interface = static_cast<AllocLayoutAsyncInterface*>(context);
-    interface->on_result(Converters::from(*result));
+    interface->on_result(
+        interface->_observer.record(AllocPolicy::GcDefragAsync, Converters::from(*result), interface->_start));
 }
 
 inline void _z_alloc_layout_async_interface_drop_fn(void* context) {
@@ -96,5 +105,38 @@ class AllocLayout : public Owned<::z_owned_alloc_layout_t> {
             &rcv->_result, interop::as_loaned_c_ptr(*this), context,
             shm::provider::closures::_z_alloc_layout_async_interface_result_fn);
     }
+
+    /// @brief Allocate a buffer asynchronously, see ``alloc_gc_defrag_blocking``.
+    /// @param on_result callable invoked with the ``BufAllocResult`` once the allocation completes, on a Zenoh thread.
+    /// It receives ``Z_ALLOC_ERROR_OTHER`` if the allocation is dropped without completing. Exceptions thrown by
+    /// ``on_result`` are discarded.
+    /// @return 0 in case of success, negative error code otherwise.
+    template <class F, class = std::enable_if_t<std::is_invocable_v<F&, BufAllocResult&&>>>
+    ZResult alloc_gc_defrag_async(F&& on_result) const {
+        using Callback = detail::ShmAsyncCallback<AllocLayoutAsyncInterface, BufAllocResult, std::decay_t<F>>;
+        return alloc_gc_defrag_async(
+            std::make_unique<Callback>(std::decay_t<F>(std::forward<F>(on_result)), AllocError(Z_ALLOC_ERROR_OTHER)));
+    }
+
+    /// @brief Allocate a buffer asynchronously, see ``alloc_gc_defrag_blocking``.
+    /// @return a future of the allocation result, set to ``Z_ALLOC_ERROR_OTHER`` if the allocation could not complete.
+    std::future<BufAllocResult> alloc_gc_defrag_async() const {
+        std::promise<BufAllocResult> promise;
+        auto future = promise.get_future();
+        alloc_gc_defrag_async([promise = std::move(promise)](BufAllocResult&& result) mutable {
+            promise.set_value(std::move(result));
+        });
+        return future;
+    }
+
+#ifdef ZENOHCXX_SHM_COROUTINES
+    /// @brief Allocate a buffer asynchronously from a coroutine, see ``alloc_gc_defrag_blocking``:
+    /// ``BufAllocResult result = co_await layout.alloc_gc_defrag_awaitable();``. The coroutine is resumed on a Zenoh
+    /// thread. Only available with C++20 coroutines.
+    auto alloc_gc_defrag_awaitable() const {
+        auto launch = [this](auto&& on_result) { alloc_gc_defrag_async(std::move(on_result)); };
+        return detail::ShmAllocAwaiter<BufAllocResult, decltype(launch)>(std::move(launch));
+    }
+#endif
 };
 }  // end of namespace zenoh
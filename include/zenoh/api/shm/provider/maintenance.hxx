@@ -0,0 +1,225 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "shm_provider.hxx"
+#include "stats.hxx"
+#include "stats_collector.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A background thread running garbage collection and defragmentation of a ``ShmProvider``, so that producers
+/// can allocate with ``ShmProvider::alloc`` and do not pay for them on the hot path.
+///
+/// The thread polls the occupancy of the provider. Garbage collection runs when the used part of the provider memory
+/// crosses ``gc_watermark``, and defragmentation when it is still above ``defrag_watermark`` afterwards, or when the
+/// largest free block is less than ``max_fragmentation`` of the free memory. The poll interval starts at
+/// ``min_interval`` and doubles up to ``max_interval`` as long as the provider is idle, i.e. its available memory does
+/// not change; any change, or a call to ``wake``, brings it back to ``min_interval``.
+///
+/// While the provider is used above ``gc_watermark``, garbage collection runs on every poll, i.e. every
+/// ``max_interval`` once the provider is idle, and stops once a collection left it below the watermark: buffers
+/// released by readers while the producers are idle are reclaimed without ``wake``. Defragmentation only runs on polls
+/// where the provider is in use, or right after a garbage collection which reclaimed memory.
+///
+/// The occupancy of the provider is known when the thread is started with a ``ShmProviderStatsCollector`` reporting
+/// it, see ``ShmProviderStats::total``; garbage collection and defragmentation are then also recorded by the collector.
+/// Otherwise, garbage collection runs on every poll where the provider is in use, and keeps running while it reclaims
+/// memory.
+///
+/// The maintenance thread uses the provider concurrently with the producers, so the provider must be threadsafe, e.g.
+/// a ``PosixShmProvider`` or a ``CppShmProvider`` over a ``CppShmProviderBackendThreadsafe``. The provider, and the
+/// collector if any, must outlive the maintenance thread, which stops on destruction.
+class ShmProviderMaintenance {
+   public:
+    /// @brief Options to be passed when constructing ``ShmProviderMaintenance``.
+    struct ShmProviderMaintenanceOptions {
+        /// @name Fields
+
+        /// @brief Fraction of the provider memory in use above which garbage collection runs.
+        double gc_watermark = 0.5;
+        /// @brief Fraction of the provider memory in use after garbage collection above which defragmentation runs.
+        double defrag_watermark = 0.8;
+        /// @brief Defragmentation also runs when the largest free block is smaller than this fraction of the free
+        /// memory, if the collector reports it, see ``ShmProviderStats::largest_free``.
+        double max_fragmentation = 0.5;
+        /// @brief Poll interval while the provider is in use.
+        std::chrono::milliseconds min_interval = std::chrono::milliseconds(1);
+        /// @brief Poll interval once the provider is idle.
+        std::chrono::milliseconds max_interval = std::chrono::milliseconds(100);
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmProviderMaintenanceOptions create_default() { return {}; }
+    };
+
+    /// @brief Statistics of the maintenance thread.
+    struct Stats {
+        /// @brief Number of polls of the provider.
+        uint64_t polls = 0;
+        /// @brief Number of garbage collections.
+        uint64_t gc_runs = 0;
+        /// @brief Number of bytes reclaimed by garbage collection.
+        uint64_t collected = 0;
+        /// @brief Number of defragmentations.
+        uint64_t defrag_runs = 0;
+    };
+
+    /// @name Constructors
+
+    /// @brief Start the maintenance thread of a provider.
+    /// @param provider the provider to maintain.
+    /// @param options options of the maintenance.
+    ShmProviderMaintenance(const ShmProvider& provider,
+                           ShmProviderMaintenanceOptions&& options = ShmProviderMaintenanceOptions::create_default())
+        : _provider(provider), _options(std::move(options)) {
+        start();
+    }
+
+    /// @brief Start the maintenance thread of the provider of a collector.
+    /// @param collector the collector of the provider to maintain, reporting its occupancy.
+    /// @param options options of the maintenance.
+    ShmProviderMaintenance(const ShmProviderStatsCollector& collector,
+                           ShmProviderMaintenanceOptions&& options = ShmProviderMaintenanceOptions::create_default())
+        : _provider(collector.provider()), _collector(&collector), _options(std::move(options)) {
+        start();
+    }
+
+    ShmProviderMaintenance(const ShmProviderMaintenance&) = delete;
+    ShmProviderMaintenance& operator=(const ShmProviderMaintenance&) = delete;
+
+    ~ShmProviderMaintenance() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_one();
+        _thread.join();
+    }
+
+    /// @name Methods
+
+    /// @brief Poll the provider immediately, e.g. after an allocation failed.
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _woken = true;
+        }
+        _cv.notify_one();
+    }
+
+    /// @brief Get the statistics of the maintenance thread.
+    Stats stats() const {
+        Stats out;
+        out.polls = _polls.load(std::memory_order_relaxed);
+        out.gc_runs = _gc_runs.load(std::memory_order_relaxed);
+        out.collected = _collected.load(std::memory_order_relaxed);
+        out.defrag_runs = _defrag_runs.load(std::memory_order_relaxed);
+        return out;
+    }
+
+   private:
+    void start() {
+        _options.max_interval = std::max(_options.max_interval, _options.min_interval);
+        if (_collector != nullptr) _total = _collector->stats().total;
+        _thread = std::thread([this]() { run(); });
+    }
+
+    void run() {
+        auto interval = _options.min_interval;
+        std::optional<size_t> last_available;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_stop) {
+            _cv.wait_for(lock, interval, [this]() { return _stop || _woken; });
+            if (_stop) break;
+            bool woken = _woken;
+            _woken = false;
+            lock.unlock();
+            bool active = poll(last_available, woken);
+            interval = active ? _options.min_interval : std::min(interval * 2, _options.max_interval);
+            lock.lock();
+        }
+    }
+
+    // Returns true if the provider was in use since the previous poll, or the thread was woken.
+    bool poll(std::optional<size_t>& last_available, bool woken) {
+        _polls.fetch_add(1, std::memory_order_relaxed);
+        size_t available = _provider.available();
+        bool active = last_available != available || woken;
+        // Without the occupancy, an idle provider is only collected again while collections keep reclaiming memory.
+        bool gc = _total.has_value() ? used_fraction(available) > _options.gc_watermark
+                                     : active || _last_collected > 0;
+        _last_collected = 0;
+        if (gc) {
+            _last_collected = _collector != nullptr ? _collector->garbage_collect() : _provider.garbage_collect();
+            _gc_runs.fetch_add(1, std::memory_order_relaxed);
+            _collected.fetch_add(_last_collected, std::memory_order_relaxed);
+            available = _provider.available();
+        }
+        if (active || _last_collected > 0) {
+            bool defrag = _total.has_value() && used_fraction(available) > _options.defrag_watermark;
+            if (!defrag && available > 0 && _collector != nullptr) {
+                auto largest_free = _collector->stats().largest_free;
+                double threshold = _options.max_fragmentation * static_cast<double>(available);
+                defrag = largest_free.has_value() && static_cast<double>(*largest_free) < threshold;
+            }
+            if (defrag) {
+                if (_collector != nullptr) {
+                    _collector->defragment();
+                } else {
+                    _provider.defragment();
+                }
+                _defrag_runs.fetch_add(1, std::memory_order_relaxed);
+                available = _provider.available();
+            }
+        }
+        last_available = available;
+        return active;
+    }
+
+    double used_fraction(size_t available) const {
+        if (*_total == 0) return 0.0;
+        size_t used = *_total > available ? *_total - available : 0;
+        return static_cast<double>(used) / static_cast<double>(*_total);
+    }
+
+    const ShmProvider& _provider;
+    const ShmProviderStatsCollector* _collector = nullptr;
+    ShmProviderMaintenanceOptions _options;
+    std::optional<size_t> _total;
+    // Only used by the maintenance thread.
+    size_t _last_collected = 0;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+    bool _woken = false;
+    std::atomic<uint64_t> _polls = 0;
+    std::atomic<uint64_t> _gc_runs = 0;
+    std::atomic<uint64_t> _collected = 0;
+    std::atomic<uint64_t> _defrag_runs = 0;
+    std::thread _thread;
+};
+
+}  // end of namespace zenoh
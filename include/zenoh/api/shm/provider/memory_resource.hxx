@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#if __has_include(<memory_resource>)
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <unordered_map>
+#include <variant>
+
+#include "../buffer/zshm.hxx"
+#include "shm_provider.hxx"
+#include "stats.hxx"
+#include "types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A ``std::pmr::memory_resource`` allocating from a ``ShmProvider``, so that ``std::pmr`` containers can be
+/// built directly in shared memory and then published without copies.
+///
+/// Every allocation of the resource is a separate SHM buffer. The buffer holding an allocation can be obtained with
+/// ``ShmMemoryResource::share`` and published like any other ``ZShm``, e.g. the element storage of a
+/// ``std::pmr::vector`` of trivially copyable elements. Pointers stored inside an allocation are only meaningful in
+/// the process which wrote them, since every process maps the segments at its own addresses.
+///
+/// Deallocating an allocation only drops the reference of the resource: the buffer is reclaimed by the provider
+/// garbage collection once all its readers are done with it. The provider must outlive the resource, and allocations
+/// not deallocated are released when the resource is destroyed. The resource can be used from several threads.
+///
+/// A failed allocation throws ``std::bad_alloc``, or aborts the program when exceptions are disabled.
+class ShmMemoryResource : public std::pmr::memory_resource {
+   public:
+    /// @brief Options to be passed when constructing ``ShmMemoryResource``.
+    struct ShmMemoryResourceOptions {
+        /// @name Fields
+
+        /// @brief The provider allocation method to use. ``AllocPolicy::GcDefragAsync`` waits for the allocation
+        /// like ``AllocPolicy::GcDefragBlocking``.
+        AllocPolicy policy = AllocPolicy::GcDefrag;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmMemoryResourceOptions create_default() { return {}; }
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new memory resource.
+    /// @param provider the provider to allocate from.
+    /// @param options options of the resource.
+    ShmMemoryResource(const ShmProvider& provider,
+                      ShmMemoryResourceOptions&& options = ShmMemoryResourceOptions::create_default())
+        : _provider(provider), _options(std::move(options)) {}
+
+    ShmMemoryResource(const ShmMemoryResource&) = delete;
+    ShmMemoryResource& operator=(const ShmMemoryResource&) = delete;
+
+    /// @name Methods
+
+    /// @brief Get the SHM buffer holding an allocation of the resource.
+    /// @param p pointer returned by ``allocate``, e.g. ``std::pmr::vector::data``.
+    /// @return a reference to the whole buffer of the allocation, which may be larger than requested, or an empty
+    /// value if ``p`` was not allocated by this resource. Writing to the allocation while the buffer is being read is
+    /// a data race.
+    std::optional<ZShm> share(const void* p) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _buffers.find(p);
+        if (it == _buffers.end()) return std::nullopt;
+        return ZShm(it->second);
+    }
+
+    /// @brief Check if a pointer was returned by ``allocate`` and is not yet deallocated.
+    bool owns(const void* p) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _buffers.count(p) != 0;
+    }
+
+    /// @brief Get the number of live allocations.
+    size_t allocation_count() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _buffers.size();
+    }
+
+    /// @brief Get the total size of the buffers of the live allocations.
+    size_t allocated_bytes() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _allocated;
+    }
+
+    /// @brief Get the provider of the resource.
+    const ShmProvider& provider() const { return _provider; }
+
+   protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        uint8_t pow = 0;
+        while ((size_t(1) << pow) < alignment) pow++;
+        BufLayoutAllocResult result =
+            detail::alloc_with_policy(_provider, bytes > 0 ? bytes : 1, AllocAlignment({pow}), _options.policy);
+        if (!std::holds_alternative<ZShmMut>(result)) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+            throw std::bad_alloc();
+#else
+            std::abort();
+#endif
+        }
+        ZShmMut& buf = std::get<ZShmMut>(result);
+        void* p = buf.data();
+        size_t len = buf.len();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.emplace(p, ZShm(std::move(buf)));
+        _allocated += len;
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t, size_t) override {
+        std::optional<ZShm> dropped;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _buffers.find(p);
+        if (it == _buffers.end()) return;
+        _allocated -= it->second.len();
+        dropped.emplace(std::move(it->second));
+        _buffers.erase(it);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+   private:
+    const ShmProvider& _provider;
+    ShmMemoryResourceOptions _options;
+    mutable std::mutex _mutex;
+    std::unordered_map<const void*, ZShm> _buffers;
+    size_t _allocated = 0;
+};
+
+}  // end of namespace zenoh
+
+#endif
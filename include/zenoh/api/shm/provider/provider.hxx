@@ -16,6 +16,12 @@
 
 #include "alloc_layout.hxx"
 #include "chunk.hxx"
+#include "maintenance.hxx"
+#include "memory_resource.hxx"
 #include "shm_provider.hxx"
 #include "shm_provider_backend.hxx"
+#include "slab_shm_provider_backend.hxx"
+#include "stats.hxx"
+#include "stats_collector.hxx"
+#include "tlsf_shm_provider_backend.hxx"
 #include "types.hxx"
@@ -16,10 +16,15 @@
 
 #include <memory.h>
 
+#include <future>
+#include <type_traits>
+
 #include "../../base.hxx"
+#include "../common/async.hxx"
 #include "../common/common.hxx"
 #include "chunk.hxx"
 #include "shm_provider_backend.hxx"
+#include "stats.hxx"
 #include "types.hxx"
 #include "types_impl.hxx"
 
@@ -27,8 +32,11 @@ namespace zenoh {
 
 class ShmProviderAsyncInterface {
     friend class ShmProvider;
+    friend class ShmProviderStatsCollector;
 
     z_buf_layout_alloc_result_t _result;
+    detail::ShmStatsObserver _observer;
+    detail::ShmStatsCollector::Clock::time_point _start;
 
     virtual void on_result(BufLayoutAllocResult&& result) = 0;
 
@@ -39,7 +47,8 @@ class ShmProviderAsyncInterface {
 
     static void result(void* context, struct z_buf_layout_alloc_result_t* result) {
         auto interface = static_cast<ShmProviderAsyncInterface*>(context);
-        interface->on_result(Converters::from(*result));
+        interface->on_result(interface->_observer.record(AllocPolicy::GcDefragAsync, Converters::from(*result),
+                                                         interface->_start));
     }
 
    public:
@@ -91,6 +100,48 @@ class ShmProvider : public Owned<::z_owned_shm_provider_t> {
                                                       context, ShmProviderAsyncInterface::result);
     }
 
+    /// @brief Allocate a buffer asynchronously, see ``alloc_gc_defrag_blocking``.
+    /// @param size size of the buffer.
+    /// @param alignment alignment of the buffer.
+    /// @param on_result callable invoked with the ``BufLayoutAllocResult`` once the allocation completes, on a Zenoh
+    /// thread. It receives ``Z_ALLOC_ERROR_OTHER`` if the allocation is dropped without completing. Exceptions thrown
+    /// by ``on_result`` are discarded.
+    /// @return 0 in case of success, negative error code otherwise.
+    template <class F, class = std::enable_if_t<std::is_invocable_v<F&, BufLayoutAllocResult&&>>>
+    ZResult alloc_gc_defrag_async(size_t size, AllocAlignment alignment, F&& on_result) const {
+        using Callback = detail::ShmAsyncCallback<ShmProviderAsyncInterface, BufLayoutAllocResult, std::decay_t<F>>;
+        return alloc_gc_defrag_async(
+            size, alignment,
+            std::make_unique<Callback>(std::decay_t<F>(std::forward<F>(on_result)), AllocError(Z_ALLOC_ERROR_OTHER)));
+    }
+
+    /// @brief Allocate a buffer asynchronously, see ``alloc_gc_defrag_blocking``.
+    /// @param size size of the buffer.
+    /// @param alignment alignment of the buffer.
+    /// @return a future of the allocation result, set to ``Z_ALLOC_ERROR_OTHER`` if the allocation could not complete.
+    std::future<BufLayoutAllocResult> alloc_gc_defrag_async(size_t size, AllocAlignment alignment) const {
+        std::promise<BufLayoutAllocResult> promise;
+        auto future = promise.get_future();
+        alloc_gc_defrag_async(size, alignment, [promise = std::move(promise)](BufLayoutAllocResult&& result) mutable {
+            promise.set_value(std::move(result));
+        });
+        return future;
+    }
+
+#ifdef ZENOHCXX_SHM_COROUTINES
+    /// @brief Allocate a buffer asynchronously from a coroutine, see ``alloc_gc_defrag_blocking``:
+    /// ``BufLayoutAllocResult result = co_await provider.alloc_gc_defrag_awaitable(size, alignment);``. The coroutine
+    /// is resumed on a Zenoh thread. Only available with C++20 coroutines.
+    /// @param size size of the buffer.
+    /// @param alignment alignment of the buffer.
+    auto alloc_gc_defrag_awaitable(size_t size, AllocAlignment alignment) const {
+        auto launch = [this, size, alignment](auto&& on_result) {
+            alloc_gc_defrag_async(size, alignment, std::move(on_result));
+        };
+        return detail::ShmAllocAwaiter<BufLayoutAllocResult, decltype(launch)>(std::move(launch));
+    }
+#endif
+
     void defragment() const { ::z_shm_provider_defragment(interop::as_loaned_c_ptr(*this)); }
 
     std::size_t garbage_collect() const { return ::z_shm_provider_garbage_collect(interop::as_loaned_c_ptr(*this)); }
@@ -104,6 +155,28 @@ class ShmProvider : public Owned<::z_owned_shm_provider_t> {
     }
 };
 
+namespace detail {
+/// Allocates with the method of ``policy``. ``AllocPolicy::GcDefragAsync`` waits like
+/// ``AllocPolicy::GcDefragBlocking``.
+inline BufLayoutAllocResult alloc_with_policy(const ShmProvider& provider, size_t size, AllocAlignment alignment,
+                                              AllocPolicy policy) {
+    switch (policy) {
+        case AllocPolicy::Alloc:
+            return provider.alloc(size, alignment);
+        case AllocPolicy::Gc:
+            return provider.alloc_gc(size, alignment);
+        case AllocPolicy::GcDefrag:
+            return provider.alloc_gc_defrag(size, alignment);
+        case AllocPolicy::GcDefragDealloc:
+            return provider.alloc_gc_defrag_dealloc(size, alignment);
+        case AllocPolicy::GcDefragBlocking:
+        case AllocPolicy::GcDefragAsync:
+            break;
+    }
+    return provider.alloc_gc_defrag_blocking(size, alignment);
+}
+}  // namespace detail
+
 /// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
 class CppShmProvider : public ShmProvider {
     friend class AllocLayout;
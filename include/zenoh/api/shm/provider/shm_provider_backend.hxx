@@ -14,9 +14,14 @@
 
 #pragma once
 
+#include <cstdint>
+#include <new>
+#include <optional>
+
 #include "../../base.hxx"
 #include "../../interop.hxx"
 #include "chunk.hxx"
+#include "stats.hxx"
 #include "types.hxx"
 
 namespace zenoh {
@@ -28,6 +33,9 @@ class CppShmProviderBackendIface {
     virtual size_t defragment() = 0;
     virtual size_t available() const = 0;
     virtual void layout_for(MemoryLayout &layout) = 0;
+    /// @brief Report the occupancy of the backend, to be included in ``ShmProviderStatsCollector::stats``. Backends
+    /// which do not know it keep the default implementation, returning nothing.
+    virtual std::optional<ShmOccupancy> occupancy() const { return std::nullopt; }
     virtual ~CppShmProviderBackendIface() = default;
 };
 
@@ -35,6 +43,27 @@ class CppShmProviderBackend : public CppShmProviderBackendIface {};
 
 class CppShmProviderBackendThreadsafe : public CppShmProviderBackend {};
 
+namespace detail {
+/// Memory owned by a C++ backend, aligned to ``2^alignment_pow``.
+class BackendMemory {
+   public:
+    BackendMemory(size_t len, uint8_t alignment_pow)
+        : _align(size_t(1) << alignment_pow),
+          _owned(static_cast<uint8_t*>(::operator new(len > 0 ? len : 1, std::align_val_t(_align)))) {}
+    BackendMemory() = default;
+    BackendMemory(const BackendMemory&) = delete;
+    BackendMemory& operator=(const BackendMemory&) = delete;
+    ~BackendMemory() {
+        if (_owned != nullptr) ::operator delete(_owned, std::align_val_t(_align));
+    }
+    uint8_t* data() const { return _owned; }
+
+   private:
+    size_t _align = 1;
+    uint8_t* _owned = nullptr;
+};
+}  // namespace detail
+
 // Ensure that function pointers are defined with extern C linkage
 namespace shm::provider_backend::closures {
 extern "C" {
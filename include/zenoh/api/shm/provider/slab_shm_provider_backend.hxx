@@ -0,0 +1,566 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "../../base.hxx"
+#include "../../interop.hxx"
+#include "../common/types.hxx"
+#include "chunk.hxx"
+#include "shm_provider_backend.hxx"
+#include "types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A size class of a slab SHM provider backend.
+struct SlabSizeClass {
+    /// @brief Size of the chunks of the class.
+    size_t size;
+    /// @brief Number of chunks of the class.
+    size_t count;
+};
+
+namespace detail {
+/// Slab allocator over a memory region: every size class owns a contiguous array of chunks, and its free chunks are
+/// linked by offsets stored inside the chunks themselves.
+class SlabAllocator {
+   public:
+    static constexpr size_t NIL = std::numeric_limits<size_t>::max();
+
+    SlabAllocator() = default;
+
+    /// Number of bytes of the region needed by the given size classes.
+    static size_t required_size(const std::vector<SlabSizeClass>& classes, uint8_t alignment_pow) {
+        size_t total = 0;
+        for (const auto& c : classes) total += stride(c.size, alignment_pow) * c.count;
+        return total;
+    }
+
+    ZResult init(uint8_t* base, size_t len, SegmentId segment, std::vector<SlabSizeClass> classes,
+                 uint8_t alignment_pow) {
+        if (classes.empty() || alignment_pow >= 32 ||
+            reinterpret_cast<uintptr_t>(base) % (size_t(1) << alignment_pow) != 0) {
+            return Z_EINVAL;
+        }
+        for (const auto& c : classes) {
+            if (c.size == 0 || c.count == 0) return Z_EINVAL;
+        }
+        size_t total = required_size(classes, alignment_pow);
+        if (total > len || total > std::numeric_limits<z_chunk_id_t>::max()) return Z_EINVAL;
+
+        std::sort(classes.begin(), classes.end(),
+                  [](const SlabSizeClass& a, const SlabSizeClass& b) { return a.size < b.size; });
+        _base = base;
+        _segment = segment;
+        _alignment_pow = alignment_pow;
+        _available = 0;
+        _classes.clear();
+        size_t offset = 0;
+        for (const auto& c : classes) {
+            Class cls;
+            cls.size = c.size;
+            cls.stride = stride(c.size, alignment_pow);
+            cls.begin = offset;
+            cls.end = offset + cls.stride * c.count;
+            cls.head = NIL;
+            cls.free = 0;
+            // Link the chunks in increasing offset order.
+            for (size_t i = c.count; i > 0; i--) push(cls, cls.begin + (i - 1) * cls.stride);
+            _available += cls.size * cls.free;
+            offset = cls.end;
+            _classes.push_back(cls);
+        }
+        return Z_OK;
+    }
+
+    /// Allocates from the smallest class fitting the layout, or from the next larger ones when it is exhausted.
+    ChunkAllocResult alloc(const MemoryLayout& layout) {
+        const size_t size = layout.size();
+        if (layout.alignment().pow > _alignment_pow) return ChunkAllocResult(AllocError::Z_ALLOC_ERROR_OTHER);
+        for (auto& cls : _classes) {
+            if (cls.size < size || cls.head == NIL) continue;
+            size_t offset = pop(cls);
+            _available -= cls.size;
+            return ChunkAllocResult(chunk(offset, size));
+        }
+        return ChunkAllocResult(AllocError::Z_ALLOC_ERROR_OUT_OF_MEMORY);
+    }
+
+    void free(const ChunkDescriptor& chunk) {
+        size_t cls = class_of(chunk.chunk);
+        if (cls != NIL) give(cls, chunk.chunk);
+    }
+
+    /// Index of the smallest class whose chunks fit the layout, free or not, or ``NIL`` if there is none.
+    size_t class_for(const MemoryLayout& layout) const {
+        if (layout.alignment().pow > _alignment_pow) return NIL;
+        for (size_t i = 0; i < _classes.size(); i++) {
+            if (_classes[i].size >= layout.size()) return i;
+        }
+        return NIL;
+    }
+
+    /// Index of the class owning the chunk at ``offset``, or ``NIL`` if there is none.
+    size_t class_of(size_t offset) const {
+        for (size_t i = 0; i < _classes.size(); i++) {
+            if (offset >= _classes[i].begin && offset < _classes[i].end) return i;
+        }
+        return NIL;
+    }
+
+    size_t class_count() const { return _classes.size(); }
+
+    size_t class_size(size_t cls) const { return _classes[cls].size; }
+
+    /// Takes up to ``count`` free chunks of a class, appending their offsets to ``out``.
+    void take(size_t cls, size_t count, std::vector<size_t>& out) {
+        Class& c = _classes[cls];
+        for (; count > 0 && c.head != NIL; count--) {
+            out.push_back(pop(c));
+            _available -= c.size;
+        }
+    }
+
+    /// Gives back a chunk of a class taken with ``take``.
+    void give(size_t cls, size_t offset) {
+        push(_classes[cls], offset);
+        _available += _classes[cls].size;
+    }
+
+    /// The chunk at ``offset``, allocated for ``len`` bytes.
+    AllocatedChunk chunk(size_t offset, size_t len) const {
+        AllocatedChunk chunk;
+        chunk.data = _base + offset;
+        chunk.descriptpr.segment = _segment;
+        chunk.descriptpr.chunk = static_cast<z_chunk_id_t>(offset);
+        chunk.descriptpr.len = len;
+        return chunk;
+    }
+
+    size_t available() const { return _available; }
+
+    ShmOccupancy occupancy() const {
+        ShmOccupancy o = {0, 0};
+        for (const auto& cls : _classes) {
+            o.total += cls.size * ((cls.end - cls.begin) / cls.stride);
+            if (cls.free > 0) o.largest_free = cls.size;
+        }
+        return o;
+    }
+
+    bool fits(const MemoryLayout& layout) const {
+        return !_classes.empty() && layout.size() <= _classes.back().size &&
+               layout.alignment().pow <= _alignment_pow;
+    }
+
+   private:
+    struct Class {
+        size_t size;
+        size_t stride;
+        size_t begin;
+        size_t end;
+        size_t head;
+        size_t free;
+    };
+
+    static size_t stride(size_t size, uint8_t alignment_pow) {
+        const size_t align = size_t(1) << alignment_pow;
+        size = std::max(size, sizeof(size_t));
+        return (size + align - 1) / align * align;
+    }
+
+    void push(Class& cls, size_t offset) {
+        std::memcpy(_base + offset, &cls.head, sizeof(size_t));
+        cls.head = offset;
+        cls.free++;
+    }
+
+    size_t pop(Class& cls) {
+        size_t offset = cls.head;
+        std::memcpy(&cls.head, _base + offset, sizeof(size_t));
+        cls.free--;
+        return offset;
+    }
+
+    uint8_t* _base = nullptr;
+    SegmentId _segment = 0;
+    uint8_t _alignment_pow = 0;
+    size_t _available = 0;
+    std::vector<Class> _classes;
+};
+}  // namespace detail
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A slab allocator backend for ``CppShmProvider``, for messages of a few fixed sizes.
+///
+/// The memory is split into size classes, each one being an array of chunks of the same size. Allocations and
+/// deallocations are O(1): the free chunks of a class are linked by offsets stored inside the free chunks themselves,
+/// and chunks are never split nor merged, so the backend does not fragment. An allocation is served by the smallest
+/// class whose chunks fit the requested size, or by the next larger classes if that one is exhausted.
+///
+/// The chunk ids of the allocated chunks are their offsets in the memory of the backend. The backend can allocate
+/// its own memory, usable within the process only, or manage a region provided by the caller, e.g. a shared memory
+/// segment mapped by the ``CppShmClient`` registered for the protocol id of the provider.
+///
+/// This backend is not threadsafe, see ``SlabShmProviderBackendThreadsafe`` for providers shared between threads.
+class SlabShmProviderBackend : public CppShmProviderBackend {
+   public:
+    /// @name Constructors
+
+    /// @brief Create a slab backend over its own memory.
+    /// @param classes the size classes.
+    /// @param alignment_pow log2 of the alignment of the chunks.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    SlabShmProviderBackend(const std::vector<SlabSizeClass>& classes, uint8_t alignment_pow = 6,
+                           ZResult* err = nullptr)
+        : _memory(detail::SlabAllocator::required_size(classes, alignment_pow), alignment_pow) {
+        __ZENOH_RESULT_CHECK(_slab.init(_memory.data(), detail::SlabAllocator::required_size(classes, alignment_pow),
+                                        0, classes, alignment_pow),
+                             err, "Failed to create slab SHM provider backend: incorrect size classes");
+    }
+
+    /// @brief Create a slab backend over a memory region provided by the caller.
+    /// @param base start of the region, aligned to ``2^alignment_pow``. It must outlive the backend.
+    /// @param len size of the region, at least ``SlabShmProviderBackend::required_size(classes, alignment_pow)`` and at
+    /// most 4 GiB.
+    /// @param segment id of the segment, passed in the chunk descriptors.
+    /// @param classes the size classes.
+    /// @param alignment_pow log2 of the alignment of the chunks.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    SlabShmProviderBackend(uint8_t* base, size_t len, SegmentId segment, const std::vector<SlabSizeClass>& classes,
+                           uint8_t alignment_pow = 6, ZResult* err = nullptr) {
+        __ZENOH_RESULT_CHECK(_slab.init(base, len, segment, classes, alignment_pow), err,
+                             "Failed to create slab SHM provider backend: incorrect memory region or size classes");
+    }
+
+    /// @name Methods
+
+    /// @brief Get the size of the memory region needed by the given size classes.
+    static size_t required_size(const std::vector<SlabSizeClass>& classes, uint8_t alignment_pow = 6) {
+        return detail::SlabAllocator::required_size(classes, alignment_pow);
+    }
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) override { return _slab.alloc(layout); }
+
+    void free(const ChunkDescriptor& chunk) override { _slab.free(chunk); }
+
+    size_t defragment() override { return 0; }
+
+    size_t available() const override { return _slab.available(); }
+
+    std::optional<ShmOccupancy> occupancy() const override { return _slab.occupancy(); }
+
+    void layout_for(MemoryLayout& layout) override {
+        if (!_slab.fits(layout)) layout = interop::detail::null<MemoryLayout>();
+    }
+
+   private:
+    detail::BackendMemory _memory;
+    detail::SlabAllocator _slab;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A threadsafe version of ``SlabShmProviderBackend``, to be used by ``CppShmProvider`` shared between threads.
+///
+/// Every thread allocating from the backend keeps its own cache of free chunks per size class, so that most
+/// allocations and deallocations do not take the lock of the shared slab. A thread whose cache is empty takes a batch
+/// of chunks from the slab under a single lock, and a thread whose cache is full gives a batch back. Chunks freed by
+/// the garbage collection go to the cache of the thread running it, which is the allocating thread for
+/// ``ShmProvider::alloc_gc`` and the layouts: a producer collecting its own buffers keeps allocating from its cache.
+/// Only the lock of the backend is avoided, Zenoh still keeps track of the allocated chunks on its side.
+///
+/// Cached chunks are counted as available. They are moved back to the slab when an allocation can not be served
+/// otherwise, and by ``defragment``, so that chunks cached by idle or exited threads are not lost.
+///
+/// The backend is owned by the provider: keep a pointer to it before passing it to ``CppShmProvider`` to read its
+/// ``stats`` later on.
+class SlabShmProviderBackendThreadsafe : public CppShmProviderBackendThreadsafe {
+   public:
+    /// @brief Options to be passed when constructing ``SlabShmProviderBackendThreadsafe``.
+    struct SlabShmProviderBackendThreadsafeOptions {
+        /// @name Fields
+
+        /// @brief Number of chunks moved at once between the slab and the cache of a thread, at least 1.
+        size_t batch = 16;
+        /// @brief Maximum number of chunks of a size class kept in the cache of a thread, at least ``batch``. Beyond
+        /// it, a batch of chunks is given back to the slab.
+        size_t capacity = 64;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static SlabShmProviderBackendThreadsafeOptions create_default() { return {}; }
+    };
+
+    /// @brief Allocation statistics of a thread.
+    struct ThreadStats {
+        /// @brief Number of allocations served from the cache of the thread.
+        uint64_t hits = 0;
+        /// @brief Number of allocations which found the cache of the thread empty.
+        uint64_t misses = 0;
+        /// @brief Number of chunks taken from the slab into the cache.
+        uint64_t refilled = 0;
+        /// @brief Number of chunks given back from the cache to the slab.
+        uint64_t flushed = 0;
+
+        /// @brief Get the fraction of allocations served from the cache of the thread.
+        double hit_rate() const {
+            uint64_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+        }
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a slab backend over its own memory.
+    /// @param classes the size classes.
+    /// @param alignment_pow log2 of the alignment of the chunks.
+    /// @param options options of the thread caches.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    SlabShmProviderBackendThreadsafe(
+        const std::vector<SlabSizeClass>& classes, uint8_t alignment_pow = 6,
+        SlabShmProviderBackendThreadsafeOptions&& options = SlabShmProviderBackendThreadsafeOptions::create_default(),
+        ZResult* err = nullptr)
+        : _memory(detail::SlabAllocator::required_size(classes, alignment_pow), alignment_pow), _id(next_id()) {
+        __ZENOH_RESULT_CHECK(_slab.init(_memory.data(), detail::SlabAllocator::required_size(classes, alignment_pow),
+                                        0, classes, alignment_pow),
+                             err, "Failed to create slab SHM provider backend: incorrect size classes");
+        set_options(options);
+    }
+
+    /// @brief Create a slab backend over a memory region provided by the caller. See ``SlabShmProviderBackend``.
+    SlabShmProviderBackendThreadsafe(
+        uint8_t* base, size_t len, SegmentId segment, const std::vector<SlabSizeClass>& classes,
+        uint8_t alignment_pow = 6,
+        SlabShmProviderBackendThreadsafeOptions&& options = SlabShmProviderBackendThreadsafeOptions::create_default(),
+        ZResult* err = nullptr)
+        : _id(next_id()) {
+        __ZENOH_RESULT_CHECK(_slab.init(base, len, segment, classes, alignment_pow), err,
+                             "Failed to create slab SHM provider backend: incorrect memory region or size classes");
+        set_options(options);
+    }
+
+    /// @name Methods
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) override {
+        size_t cls = _slab.class_for(layout);
+        if (cls != detail::SlabAllocator::NIL) {
+            Magazine& m = local();
+            {
+                std::lock_guard<std::mutex> lock(m.mutex);
+                if (auto chunk = m.pop(cls, _slab, layout.size())) {
+                    m.stats.hits++;
+                    return ChunkAllocResult(*chunk);
+                }
+                m.stats.misses++;
+            }
+            std::vector<size_t> batch;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _slab.take(cls, _batch, batch);
+            }
+            if (!batch.empty()) {
+                std::lock_guard<std::mutex> lock(m.mutex);
+                m.stats.refilled += batch.size();
+                for (size_t offset : batch) m.push(cls, offset, _slab);
+                return ChunkAllocResult(*m.pop(cls, _slab, layout.size()));
+            }
+            // The class is exhausted in the slab: reclaim the chunks cached by all threads before falling back to the
+            // larger classes, as the slab would.
+            drain();
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _slab.alloc(layout);
+    }
+
+    void free(const ChunkDescriptor& chunk) override {
+        size_t cls = _slab.class_of(chunk.chunk);
+        if (cls == detail::SlabAllocator::NIL) return;
+        Magazine& m = local();
+        std::vector<size_t> overflow;
+        {
+            std::lock_guard<std::mutex> lock(m.mutex);
+            m.push(cls, chunk.chunk, _slab);
+            auto& offsets = m.free[cls];
+            if (offsets.size() <= _capacity) return;
+            size_t keep = _capacity - _batch;
+            overflow.assign(offsets.begin() + keep, offsets.end());
+            offsets.resize(keep);
+            m.bytes -= overflow.size() * _slab.class_size(cls);
+            m.stats.flushed += overflow.size();
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t offset : overflow) _slab.give(cls, offset);
+    }
+
+    /// @brief Move the chunks cached by all threads back to the slab. Chunks are never split nor merged, so nothing
+    /// else is done.
+    size_t defragment() override {
+        drain();
+        return 0;
+    }
+
+    size_t available() const override {
+        size_t cached = 0;
+        for (const auto& m : magazines()) {
+            std::lock_guard<std::mutex> lock(m->mutex);
+            cached += m->bytes;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _slab.available() + cached;
+    }
+
+    std::optional<ShmOccupancy> occupancy() const override {
+        ShmOccupancy o;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            o = _slab.occupancy();
+        }
+        for (const auto& m : magazines()) {
+            std::lock_guard<std::mutex> lock(m->mutex);
+            for (size_t cls = 0; cls < m->free.size(); cls++) {
+                if (!m->free[cls].empty()) o.largest_free = std::max(o.largest_free, _slab.class_size(cls));
+            }
+        }
+        return o;
+    }
+
+    void layout_for(MemoryLayout& layout) override {
+        if (!_slab.fits(layout)) layout = interop::detail::null<MemoryLayout>();
+    }
+
+    /// @brief Get the allocation statistics of the calling thread.
+    ThreadStats stats() const {
+        Magazine& m = local();
+        std::lock_guard<std::mutex> lock(m.mutex);
+        return m.stats;
+    }
+
+    /// @brief Get the allocation statistics of every thread which used the backend, in the order of their first
+    /// allocation or deallocation.
+    std::vector<ThreadStats> stats_all() const {
+        std::vector<ThreadStats> out;
+        for (const auto& m : magazines()) {
+            std::lock_guard<std::mutex> lock(m->mutex);
+            out.push_back(m->stats);
+        }
+        return out;
+    }
+
+   private:
+    // Free chunks cached by a thread, by size class.
+    struct Magazine {
+        // Only contended by the threads reclaiming the chunks or reading the statistics.
+        std::mutex mutex;
+        std::vector<std::vector<size_t>> free;
+        size_t bytes = 0;
+        ThreadStats stats;
+
+        void push(size_t cls, size_t offset, const detail::SlabAllocator& slab) {
+            if (free.size() <= cls) free.resize(cls + 1);
+            free[cls].push_back(offset);
+            bytes += slab.class_size(cls);
+        }
+
+        std::optional<AllocatedChunk> pop(size_t cls, const detail::SlabAllocator& slab, size_t len) {
+            if (free.size() <= cls || free[cls].empty()) return std::nullopt;
+            size_t offset = free[cls].back();
+            free[cls].pop_back();
+            bytes -= slab.class_size(cls);
+            return slab.chunk(offset, len);
+        }
+    };
+
+    // Per-thread cache of the magazines of the live backends. Entries are matched by a never reused backend id, the
+    // weak pointer only serves to prune the entries of destroyed backends.
+    struct LocalEntry {
+        uint64_t id;
+        Magazine* magazine;
+        std::weak_ptr<Magazine> owner;
+    };
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id = 0;
+        return id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void set_options(const SlabShmProviderBackendThreadsafeOptions& options) {
+        _batch = options.batch > 0 ? options.batch : 1;
+        _capacity = std::max(options.capacity, _batch);
+    }
+
+    Magazine& local() const {
+        thread_local std::vector<LocalEntry> entries;
+        for (const auto& e : entries) {
+            if (e.id == _id) return *e.magazine;
+        }
+        auto m = std::make_shared<Magazine>();
+        {
+            std::lock_guard<std::mutex> lock(_magazines_mutex);
+            _magazines.push_back(m);
+        }
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->owner.expired() ? entries.erase(it) : it + 1;
+        }
+        entries.push_back(LocalEntry{_id, m.get(), m});
+        return *m;
+    }
+
+    std::vector<std::shared_ptr<Magazine>> magazines() const {
+        std::lock_guard<std::mutex> lock(_magazines_mutex);
+        return _magazines;
+    }
+
+    // Moves the chunks cached by all threads back to the slab. The locks of a magazine and of the slab are never held
+    // together.
+    void drain() {
+        for (const auto& m : magazines()) {
+            std::vector<std::vector<size_t>> free;
+            {
+                std::lock_guard<std::mutex> lock(m->mutex);
+                for (const auto& offsets : m->free) m->stats.flushed += offsets.size();
+                free.swap(m->free);
+                m->bytes = 0;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (size_t cls = 0; cls < free.size(); cls++) {
+                for (size_t offset : free[cls]) _slab.give(cls, offset);
+            }
+        }
+    }
+
+    detail::BackendMemory _memory;
+    mutable std::mutex _mutex;
+    detail::SlabAllocator _slab;
+    uint64_t _id;
+    size_t _batch = 16;
+    size_t _capacity = 64;
+    mutable std::mutex _magazines_mutex;
+    mutable std::vector<std::shared_ptr<Magazine>> _magazines;
+};
+
+}  // end of namespace zenoh
@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief Occupancy of the memory of a SHM provider backend.
+struct ShmOccupancy {
+    /// @brief Total number of bytes the backend can allocate.
+    size_t total;
+    /// @brief Size of the largest block that can currently be allocated.
+    size_t largest_free;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief Allocation policies of ``ShmProvider`` and ``AllocLayout``, i.e. the ``alloc*`` methods.
+enum class AllocPolicy {
+    /// @brief ``alloc``.
+    Alloc,
+    /// @brief ``alloc_gc``.
+    Gc,
+    /// @brief ``alloc_gc_defrag``.
+    GcDefrag,
+    /// @brief ``alloc_gc_defrag_dealloc``.
+    GcDefragDealloc,
+    /// @brief ``alloc_gc_defrag_blocking``.
+    GcDefragBlocking,
+    /// @brief ``alloc_gc_defrag_async``.
+    GcDefragAsync,
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A histogram of latencies with power of two buckets.
+struct ShmLatencyHistogram {
+    /// @brief Number of buckets.
+    static constexpr size_t BUCKETS = 40;
+    /// @brief ``counts[i]`` is the number of latencies in ``[2^i, 2^(i+1))`` ns, the first bucket also counts the
+    /// latencies below 1 ns.
+    std::array<uint64_t, BUCKETS> counts = {};
+
+    /// @brief Get the index of the bucket of a latency.
+    static size_t bucket(std::chrono::nanoseconds latency) {
+        uint64_t ns = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+        size_t b = 0;
+        while (ns > 1 && b + 1 < BUCKETS) {
+            ns >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    /// @brief Get the number of recorded latencies.
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (auto c : counts) total += c;
+        return total;
+    }
+
+    /// @brief Get an upper bound of the ``p``-th percentile, i.e. the upper bound of the bucket it falls in.
+    /// @param p percentile, in ``[0, 100]``.
+    /// @return the upper bound, or zero if there are no recorded latencies.
+    std::chrono::nanoseconds percentile(double p) const {
+        const uint64_t total = count();
+        if (total == 0) return std::chrono::nanoseconds(0);
+        const double rank = p / 100.0 * static_cast<double>(total);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (counts[b] > 0 && static_cast<double>(seen) >= rank) {
+                return std::chrono::nanoseconds(int64_t(1) << (b + 1));
+            }
+        }
+        return std::chrono::nanoseconds(int64_t(1) << BUCKETS);
+    }
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A snapshot of the statistics of a ``ShmProvider`` or an ``AllocLayout``, see ``ShmProviderStatsCollector``
+/// and ``AllocLayoutStatsCollector``.
+///
+/// The counters and durations only cover the operations done through a collector: the collections performed by zenoh
+/// inside ``alloc_gc*`` are part of the allocation latency.
+struct ShmProviderStats {
+    /// @brief Number of bytes the provider can allocate, if known: it is reported by the backends of
+    /// ``CppShmProvider`` implementing ``CppShmProviderBackendIface::occupancy``, or given to the collector.
+    std::optional<size_t> total;
+    /// @brief Number of bytes currently available, as reported by ``ShmProvider::available``.
+    size_t available = 0;
+    /// @brief Size of the largest block that can currently be allocated, if known.
+    std::optional<size_t> largest_free;
+    /// @brief Number of allocations, indexed by ``AllocPolicy``.
+    std::array<uint64_t, 6> allocations = {};
+    /// @brief Number of allocations which failed with ``Z_ALLOC_ERROR_NEED_DEFRAGMENT``.
+    uint64_t failed_need_defragment = 0;
+    /// @brief Number of allocations which failed with ``Z_ALLOC_ERROR_OUT_OF_MEMORY``.
+    uint64_t failed_out_of_memory = 0;
+    /// @brief Number of allocations which failed with ``Z_ALLOC_ERROR_OTHER``.
+    uint64_t failed_other = 0;
+    /// @brief Number of allocations which failed with a ``LayoutError``.
+    uint64_t failed_layout = 0;
+    /// @brief Number of calls to ``ShmProvider::garbage_collect``.
+    uint64_t gc_runs = 0;
+    /// @brief Total duration of the calls to ``ShmProvider::garbage_collect``.
+    std::chrono::nanoseconds gc_time = std::chrono::nanoseconds(0);
+    /// @brief Number of calls to ``ShmProvider::defragment``.
+    uint64_t defrag_runs = 0;
+    /// @brief Total duration of the calls to ``ShmProvider::defragment``.
+    std::chrono::nanoseconds defrag_time = std::chrono::nanoseconds(0);
+    /// @brief Latencies of the allocations, for all policies. The latency of an asynchronous allocation runs until
+    /// its result is delivered.
+    ShmLatencyHistogram alloc_latency;
+
+    /// @brief Get the number of bytes in use, if the total is known.
+    std::optional<size_t> used() const {
+        if (!total.has_value()) return std::nullopt;
+        return *total > available ? *total - available : 0;
+    }
+
+    /// @brief Get the number of allocations done with a policy.
+    uint64_t allocation_count(AllocPolicy policy) const { return allocations[static_cast<size_t>(policy)]; }
+
+    /// @brief Get the total number of failed allocations.
+    uint64_t failure_count() const {
+        return failed_need_defragment + failed_out_of_memory + failed_other + failed_layout;
+    }
+
+    /// @brief Export the statistics as named metrics.
+    /// @param f a callable invoked as ``f(std::string_view name, uint64_t value)`` for every metric. Sizes are in
+    /// bytes, durations in nanoseconds. Unknown occupancy metrics are skipped.
+    template <class F>
+    void for_each_metric(F&& f) const {
+        if (total.has_value()) f("shm_total_bytes", static_cast<uint64_t>(*total));
+        if (auto u = used()) f("shm_used_bytes", static_cast<uint64_t>(*u));
+        f("shm_available_bytes", static_cast<uint64_t>(available));
+        if (largest_free.has_value()) f("shm_largest_free_bytes", static_cast<uint64_t>(*largest_free));
+        static constexpr std::string_view policy_names[] = {
+            "shm_allocs_alloc",
+            "shm_allocs_alloc_gc",
+            "shm_allocs_alloc_gc_defrag",
+            "shm_allocs_alloc_gc_defrag_dealloc",
+            "shm_allocs_alloc_gc_defrag_blocking",
+            "shm_allocs_alloc_gc_defrag_async",
+        };
+        for (size_t i = 0; i < allocations.size(); i++) f(policy_names[i], allocations[i]);
+        f("shm_alloc_failures_need_defragment", failed_need_defragment);
+        f("shm_alloc_failures_out_of_memory", failed_out_of_memory);
+        f("shm_alloc_failures_other", failed_other);
+        f("shm_alloc_failures_layout", failed_layout);
+        f("shm_gc_runs", gc_runs);
+        f("shm_gc_ns", static_cast<uint64_t>(gc_time.count()));
+        f("shm_defrag_runs", defrag_runs);
+        f("shm_defrag_ns", static_cast<uint64_t>(defrag_time.count()));
+        f("shm_alloc_latency_p50_ns", static_cast<uint64_t>(alloc_latency.percentile(50).count()));
+        f("shm_alloc_latency_p99_ns", static_cast<uint64_t>(alloc_latency.percentile(99).count()));
+        f("shm_alloc_latency_p999_ns", static_cast<uint64_t>(alloc_latency.percentile(99.9).count()));
+    }
+};
+
+namespace detail {
+/// Lock-free counters behind ``ShmProviderStats``, shared by a provider collector and its layout collectors.
+class ShmStatsCollector {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    template <class Result>
+    void record_alloc(AllocPolicy policy, const Result& result, Clock::time_point start) {
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+        _allocations[static_cast<size_t>(policy)].fetch_add(1, std::memory_order_relaxed);
+        _latency[ShmLatencyHistogram::bucket(latency)].fetch_add(1, std::memory_order_relaxed);
+        std::visit(
+            [this](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, AllocError>) {
+                    switch (v) {
+                        case AllocError::Z_ALLOC_ERROR_NEED_DEFRAGMENT:
+                            _failed_need_defragment.fetch_add(1, std::memory_order_relaxed);
+                            break;
+                        case AllocError::Z_ALLOC_ERROR_OUT_OF_MEMORY:
+                            _failed_out_of_memory.fetch_add(1, std::memory_order_relaxed);
+                            break;
+                        default:
+                            _failed_other.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } else if constexpr (std::is_same_v<T, LayoutError>) {
+                    _failed_layout.fetch_add(1, std::memory_order_relaxed);
+                }
+            },
+            result);
+    }
+
+    void record_gc(Clock::time_point start) {
+        _gc_runs.fetch_add(1, std::memory_order_relaxed);
+        _gc_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    }
+
+    void record_defrag(Clock::time_point start) {
+        _defrag_runs.fetch_add(1, std::memory_order_relaxed);
+        _defrag_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    }
+
+    void snapshot(ShmProviderStats& out) const {
+        for (size_t i = 0; i < out.allocations.size(); i++) {
+            out.allocations[i] = _allocations[i].load(std::memory_order_relaxed);
+        }
+        out.failed_need_defragment = _failed_need_defragment.load(std::memory_order_relaxed);
+        out.failed_out_of_memory = _failed_out_of_memory.load(std::memory_order_relaxed);
+        out.failed_other = _failed_other.load(std::memory_order_relaxed);
+        out.failed_layout = _failed_layout.load(std::memory_order_relaxed);
+        out.gc_runs = _gc_runs.load(std::memory_order_relaxed);
+        out.gc_time = std::chrono::nanoseconds(_gc_ns.load(std::memory_order_relaxed));
+        out.defrag_runs = _defrag_runs.load(std::memory_order_relaxed);
+        out.defrag_time = std::chrono::nanoseconds(_defrag_ns.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < ShmLatencyHistogram::BUCKETS; b++) {
+            out.alloc_latency.counts[b] = _latency[b].load(std::memory_order_relaxed);
+        }
+    }
+
+   private:
+    static uint64_t elapsed_ns(Clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    std::array<std::atomic<uint64_t>, 6> _allocations = {};
+    std::atomic<uint64_t> _failed_need_defragment = 0;
+    std::atomic<uint64_t> _failed_out_of_memory = 0;
+    std::atomic<uint64_t> _failed_other = 0;
+    std::atomic<uint64_t> _failed_layout = 0;
+    std::atomic<uint64_t> _gc_runs = 0;
+    std::atomic<uint64_t> _gc_ns = 0;
+    std::atomic<uint64_t> _defrag_runs = 0;
+    std::atomic<uint64_t> _defrag_ns = 0;
+    std::array<std::atomic<uint64_t>, ShmLatencyHistogram::BUCKETS> _latency = {};
+};
+
+/// Records the operations of a provider or a layout into its collector, and into the collector of its provider for
+/// a layout. Does nothing but a null check while statistics are disabled.
+struct ShmStatsObserver {
+    std::shared_ptr<ShmStatsCollector> stats;
+    std::shared_ptr<ShmStatsCollector> parent;
+
+    ShmStatsCollector::Clock::time_point start() const {
+        return stats != nullptr ? ShmStatsCollector::Clock::now() : ShmStatsCollector::Clock::time_point();
+    }
+
+    template <class Result>
+    Result record(AllocPolicy policy, Result&& result, ShmStatsCollector::Clock::time_point start) const {
+        if (stats != nullptr) stats->record_alloc(policy, result, start);
+        if (parent != nullptr) parent->record_alloc(policy, result, start);
+        return std::move(result);
+    }
+};
+}  // namespace detail
+
+}  // end of namespace zenoh
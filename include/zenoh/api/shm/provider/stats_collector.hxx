@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "../../base.hxx"
+#include "../common/async.hxx"
+#include "alloc_layout.hxx"
+#include "shm_provider.hxx"
+#include "shm_provider_backend.hxx"
+#include "stats.hxx"
+#include "types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief Collects the statistics of a ``ShmProvider``, see ``ShmProviderStats``.
+///
+/// The collector is attached explicitly to a provider and records the operations done through its own methods, which
+/// forward to the provider: operations done directly on the provider, or by Zenoh, are not counted. The occupancy of
+/// the provider is reported by the backend or the total given in ``ShmProviderStatsCollectorOptions``. The counters are
+/// lock-free, the collector can be used from several threads if the provider can. The provider must outlive the
+/// collector.
+class ShmProviderStatsCollector {
+   public:
+    /// @brief Options to be passed when constructing ``ShmProviderStatsCollector``.
+    struct ShmProviderStatsCollectorOptions {
+        /// @name Fields
+
+        /// @brief The backend of a ``CppShmProvider``, reporting the occupancy of the provider with
+        /// ``CppShmProviderBackendIface::occupancy``. It is owned by the provider.
+        const CppShmProviderBackendIface* backend = nullptr;
+        /// @brief Number of bytes the provider can allocate, for providers without such a backend, e.g. the size of
+        /// the layout of a ``PosixShmProvider``.
+        std::optional<size_t> total = {};
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmProviderStatsCollectorOptions create_default() { return {}; }
+    };
+
+    /// @name Constructors
+
+    /// @brief Attach a new collector to a provider.
+    /// @param provider the provider to collect the statistics of.
+    /// @param options options of the collector.
+    ShmProviderStatsCollector(
+        const ShmProvider& provider,
+        ShmProviderStatsCollectorOptions&& options = ShmProviderStatsCollectorOptions::create_default())
+        : _provider(provider), _options(std::move(options)) {
+        _observer.stats = std::make_shared<detail::ShmStatsCollector>();
+    }
+
+    ShmProviderStatsCollector(const ShmProviderStatsCollector&) = delete;
+    ShmProviderStatsCollector& operator=(const ShmProviderStatsCollector&) = delete;
+
+    /// @name Methods
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc``.
+    BufLayoutAllocResult alloc(size_t size, AllocAlignment alignment) const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::Alloc, _provider.alloc(size, alignment), start);
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc``.
+    BufLayoutAllocResult alloc_gc(size_t size, AllocAlignment alignment) const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::Gc, _provider.alloc_gc(size, alignment), start);
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc_defrag``.
+    BufLayoutAllocResult alloc_gc_defrag(size_t size, AllocAlignment alignment) const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefrag, _provider.alloc_gc_defrag(size, alignment), start);
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc_defrag_dealloc``.
+    BufLayoutAllocResult alloc_gc_defrag_dealloc(size_t size, AllocAlignment alignment) const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefragDealloc, _provider.alloc_gc_defrag_dealloc(size, alignment),
+                                start);
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc_defrag_blocking``.
+    BufLayoutAllocResult alloc_gc_defrag_blocking(size_t size, AllocAlignment alignment) const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefragBlocking, _provider.alloc_gc_defrag_blocking(size, alignment),
+                                start);
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc_defrag_async``. The latency runs until the result is
+    /// delivered to ``receiver``.
+    ZResult alloc_gc_defrag_async(size_t size, AllocAlignment alignment,
+                                  std::unique_ptr<ShmProviderAsyncInterface> receiver) const {
+        receiver->_observer = _observer;
+        receiver->_start = _observer.start();
+        return _provider.alloc_gc_defrag_async(size, alignment, std::move(receiver));
+    }
+
+    /// @brief Allocate a buffer with ``ShmProvider::alloc_gc_defrag_async``, see its callback overload.
+    template <class F, class = std::enable_if_t<std::is_invocable_v<F&, BufLayoutAllocResult&&>>>
+    ZResult alloc_gc_defrag_async(size_t size, AllocAlignment alignment, F&& on_result) const {
+        using Callback = detail::ShmAsyncCallback<ShmProviderAsyncInterface, BufLayoutAllocResult, std::decay_t<F>>;
+        return alloc_gc_defrag_async(
+            size, alignment,
+            std::make_unique<Callback>(std::decay_t<F>(std::forward<F>(on_result)), AllocError(Z_ALLOC_ERROR_OTHER)));
+    }
+
+    /// @brief Run ``ShmProvider::defragment``.
+    void defragment() const {
+        auto start = _observer.start();
+        _provider.defragment();
+        _observer.stats->record_defrag(start);
+    }
+
+    /// @brief Run ``ShmProvider::garbage_collect``.
+    std::size_t garbage_collect() const {
+        auto start = _observer.start();
+        std::size_t collected = _provider.garbage_collect();
+        _observer.stats->record_gc(start);
+        return collected;
+    }
+
+    /// @brief Get the number of bytes available in the provider, see ``ShmProvider::available``.
+    std::size_t available() const { return _provider.available(); }
+
+    /// @brief Get a snapshot of the statistics, including the ones of the ``AllocLayoutStatsCollector`` attached to
+    /// this collector.
+    ShmProviderStats stats() const {
+        ShmProviderStats out;
+        out.available = _provider.available();
+        if (_options.backend != nullptr) {
+            if (auto o = _options.backend->occupancy()) {
+                out.total = o->total;
+                out.largest_free = o->largest_free;
+            }
+        } else {
+            out.total = _options.total;
+        }
+        _observer.stats->snapshot(out);
+        return out;
+    }
+
+    /// @brief Get the provider of the collector.
+    const ShmProvider& provider() const { return _provider; }
+
+   private:
+    friend class AllocLayoutStatsCollector;
+
+    const ShmProvider& _provider;
+    ShmProviderStatsCollectorOptions _options;
+    detail::ShmStatsObserver _observer;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief Collects the allocation statistics of an ``AllocLayout``, see ``ShmProviderStatsCollector``.
+///
+/// Only the allocations done through the collector are recorded. They are also added to the statistics of the
+/// ``ShmProviderStatsCollector`` of the provider, if given. The layout, and the provider collector if any, must outlive
+/// the collector.
+class AllocLayoutStatsCollector {
+   public:
+    /// @name Constructors
+
+    /// @brief Attach a new collector to a layout.
+    /// @param layout the layout to collect the statistics of.
+    /// @param provider_stats the collector of the provider of the layout, if any.
+    AllocLayoutStatsCollector(const AllocLayout& layout, const ShmProviderStatsCollector* provider_stats = nullptr)
+        : _layout(layout) {
+        _observer.stats = std::make_shared<detail::ShmStatsCollector>();
+        if (provider_stats != nullptr) _observer.parent = provider_stats->_observer.stats;
+    }
+
+    AllocLayoutStatsCollector(const AllocLayoutStatsCollector&) = delete;
+    AllocLayoutStatsCollector& operator=(const AllocLayoutStatsCollector&) = delete;
+
+    /// @name Methods
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc``.
+    BufAllocResult alloc() const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::Alloc, _layout.alloc(), start);
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc``.
+    BufAllocResult alloc_gc() const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::Gc, _layout.alloc_gc(), start);
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc_defrag``.
+    BufAllocResult alloc_gc_defrag() const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefrag, _layout.alloc_gc_defrag(), start);
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc_defrag_dealloc``.
+    BufAllocResult alloc_gc_defrag_dealloc() const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefragDealloc, _layout.alloc_gc_defrag_dealloc(), start);
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc_defrag_blocking``.
+    BufAllocResult alloc_gc_defrag_blocking() const {
+        auto start = _observer.start();
+        return _observer.record(AllocPolicy::GcDefragBlocking, _layout.alloc_gc_defrag_blocking(), start);
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc_defrag_async``. The latency runs until the result is
+    /// delivered to ``receiver``.
+    ZResult alloc_gc_defrag_async(std::unique_ptr<AllocLayoutAsyncInterface> receiver) const {
+        receiver->_observer = _observer;
+        receiver->_start = _observer.start();
+        return _layout.alloc_gc_defrag_async(std::move(receiver));
+    }
+
+    /// @brief Allocate a buffer with ``AllocLayout::alloc_gc_defrag_async``, see its callback overload.
+    template <class F, class = std::enable_if_t<std::is_invocable_v<F&, BufAllocResult&&>>>
+    ZResult alloc_gc_defrag_async(F&& on_result) const {
+        using Callback = detail::ShmAsyncCallback<AllocLayoutAsyncInterface, BufAllocResult, std::decay_t<F>>;
+        return alloc_gc_defrag_async(
+            std::make_unique<Callback>(std::decay_t<F>(std::forward<F>(on_result)), AllocError(Z_ALLOC_ERROR_OTHER)));
+    }
+
+    /// @brief Get a snapshot of the statistics. The occupancy fields are left unset, see
+    /// ``ShmProviderStatsCollector::stats``.
+    ShmProviderStats stats() const {
+        ShmProviderStats out;
+        _observer.stats->snapshot(out);
+        return out;
+    }
+
+    /// @brief Get the layout of the collector.
+    const AllocLayout& layout() const { return _layout; }
+
+   private:
+    const AllocLayout& _layout;
+    detail::ShmStatsObserver _observer;
+};
+
+}  // end of namespace zenoh
@@ -0,0 +1,421 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "../../base.hxx"
+#include "../../interop.hxx"
+#include "../common/types.hxx"
+#include "chunk.hxx"
+#include "shm_provider_backend.hxx"
+#include "types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief Statistics of a ``TlsfShmProviderBackend``.
+struct TlsfStats {
+    /// @brief Number of bytes which can be allocated when the backend is empty.
+    size_t capacity = 0;
+    /// @brief Number of bytes which can currently be allocated, summed over all free blocks.
+    size_t free = 0;
+    /// @brief Size of the largest allocation which is guaranteed to succeed. Since requests are rounded up to the next
+    /// size class, this is the smallest size of the largest class of free blocks, not the size of the largest free
+    /// block.
+    size_t largest_free = 0;
+    /// @brief Number of free blocks.
+    size_t free_blocks = 0;
+    /// @brief Number of allocated blocks.
+    size_t used_blocks = 0;
+
+    /// @brief Get the fragmentation of the free memory: 0 if it is a single block, approaching 1 when it is split into
+    /// many small blocks.
+    double fragmentation() const {
+        return free == 0 ? 0.0 : 1.0 - static_cast<double>(largest_free) / static_cast<double>(free);
+    }
+};
+
+namespace detail {
+/// Two-Level Segregated Fit allocator over a memory region.
+///
+/// The region is divided in units of ``2^alignment_pow`` bytes. Every block starts with a one unit header, holding its
+/// size, the offset of the physically previous block and, for free blocks, the links of its free list. Free blocks
+/// are sorted in free lists by size: a first level by power of two, split into ``SL_COUNT`` linear second level
+/// ranges, with a bitmap of the non empty lists at each level, so that finding a suitable free list is a couple of bit
+/// scans. Requests are rounded up to the next size class, so that the head of any non empty list found this way fits
+/// and no list is ever searched. In exchange, a request may fail while a free block of its own class would fit it,
+/// which wastes at most ``1 / SL_COUNT`` of a block. Freed blocks are immediately merged with their free physical
+/// neighbours.
+class TlsfAllocator {
+   public:
+    ZResult init(uint8_t* base, size_t len, SegmentId segment, uint8_t alignment_pow) {
+        if (alignment_pow < 5 || alignment_pow >= 32 ||
+            reinterpret_cast<uintptr_t>(base) % (size_t(1) << alignment_pow) != 0) {
+            return Z_EINVAL;
+        }
+        // chunk ids are 32 bits offsets
+        if (len > size_t(std::numeric_limits<z_chunk_id_t>::max()) + 1) return Z_EINVAL;
+        _base = base;
+        _segment = segment;
+        _alignment_pow = alignment_pow;
+        _total = len >> alignment_pow;
+        if (_total < 2) return Z_EINVAL;
+        _fl_bitmap = 0;
+        for (auto& sl : _sl_bitmap) sl = 0;
+        for (auto& fl : _free_lists) {
+            for (auto& head : fl) head = NIL;
+        }
+        _free_units = 0;
+        _free_blocks = 0;
+        _used_blocks = 0;
+
+        Header* h = new (header_ptr(0)) Header();
+        h->size = _total;
+        h->prev_phys = NIL;
+        insert_free(0);
+        return Z_OK;
+    }
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) {
+        if (_total == 0 || layout.alignment().pow > _alignment_pow) {
+            return ChunkAllocResult(AllocError::Z_ALLOC_ERROR_OTHER);
+        }
+        const size_t size = layout.size() > 0 ? layout.size() : 1;
+        const uint64_t data_units = (uint64_t(size) + unit() - 1) >> _alignment_pow;
+        const uint64_t need = data_units + 1;
+        if (need > _total) return ChunkAllocResult(AllocError::Z_ALLOC_ERROR_OUT_OF_MEMORY);
+
+        uint64_t b = find_free(need);
+        if (b == NIL) return ChunkAllocResult(AllocError::Z_ALLOC_ERROR_OUT_OF_MEMORY);
+        remove_free(b);
+
+        Header& h = header(b);
+        if (h.size - need >= 2) {
+            const uint64_t rest = b + need;
+            Header* r = new (header_ptr(rest)) Header();
+            r->size = h.size - need;
+            r->prev_phys = b;
+            const uint64_t next = rest + r->size;
+            if (next < _total) header(next).prev_phys = rest;
+            h.size = need;
+            insert_free(rest);
+        }
+        _used_blocks++;
+
+        const uint64_t offset = (b + 1) << _alignment_pow;
+        AllocatedChunk chunk;
+        chunk.data = _base + offset;
+        chunk.descriptpr.segment = _segment;
+        chunk.descriptpr.chunk = static_cast<z_chunk_id_t>(offset);
+        chunk.descriptpr.len = size;
+        return ChunkAllocResult(chunk);
+    }
+
+    void free(const ChunkDescriptor& chunk) {
+        const uint64_t offset = chunk.chunk;
+        if (offset == 0 || (offset & (unit() - 1)) != 0) return;
+        uint64_t b = (offset >> _alignment_pow) - 1;
+        if (b >= _total || (header(b).size & FREE) != 0) return;
+        _used_blocks--;
+
+        uint64_t size = header(b).size;
+        const uint64_t next = b + size;
+        if (next < _total && (header(next).size & FREE) != 0) {
+            remove_free(next);
+            size += header(next).size;
+        }
+        const uint64_t prev = header(b).prev_phys;
+        if (prev != NIL && (header(prev).size & FREE) != 0) {
+            remove_free(prev);
+            size += header(prev).size;
+            b = prev;
+        }
+        header(b).size = size;
+        if (b + size < _total) header(b + size).prev_phys = b;
+        insert_free(b);
+    }
+
+    size_t available() const { return static_cast<size_t>((_free_units - _free_blocks) << _alignment_pow); }
+
+    bool fits(const MemoryLayout& layout) const { return layout.alignment().pow <= _alignment_pow; }
+
+    TlsfStats stats() const {
+        TlsfStats s;
+        s.capacity = _total > 0 ? static_cast<size_t>((_total - 1) << _alignment_pow) : 0;
+        s.free = available();
+        s.free_blocks = static_cast<size_t>(_free_blocks);
+        s.used_blocks = static_cast<size_t>(_used_blocks);
+        if (_fl_bitmap != 0) {
+            // Requests up to the lower bound of the highest non empty list are rounded up to at most that list.
+            const unsigned fl = fls(_fl_bitmap);
+            const unsigned sl = fls(_sl_bitmap[fl]);
+            const uint64_t lower = fl == 0 ? sl : uint64_t(SL_COUNT + sl) << (fl - 1);
+            s.largest_free = lower > 0 ? static_cast<size_t>((lower - 1) << _alignment_pow) : 0;
+        }
+        return s;
+    }
+
+   private:
+    static constexpr uint64_t NIL = std::numeric_limits<uint64_t>::max();
+    static constexpr uint64_t FREE = uint64_t(1) << 63;
+    static constexpr unsigned SL_LOG2 = 4;
+    static constexpr unsigned SL_COUNT = 1 << SL_LOG2;
+    static constexpr unsigned FL_COUNT = 64 - SL_LOG2 + 1;
+
+    // Sizes and offsets are in units, ``FREE`` is set in the size of free blocks.
+    struct Header {
+        uint64_t size;
+        uint64_t prev_phys;
+        uint64_t next_free;
+        uint64_t prev_free;
+    };
+
+    static unsigned fls(uint64_t x) {
+#if defined(_MSC_VER)
+        unsigned long i;
+        _BitScanReverse64(&i, x);
+        return static_cast<unsigned>(i);
+#else
+        return 63 - static_cast<unsigned>(__builtin_clzll(x));
+#endif
+    }
+
+    static unsigned ffs(uint64_t x) {
+#if defined(_MSC_VER)
+        unsigned long i;
+        _BitScanForward64(&i, x);
+        return static_cast<unsigned>(i);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+    }
+
+    static void mapping(uint64_t size, unsigned& fl, unsigned& sl) {
+        if (size < SL_COUNT) {
+            fl = 0;
+            sl = static_cast<unsigned>(size);
+        } else {
+            const unsigned f = fls(size);
+            sl = static_cast<unsigned>(size >> (f - SL_LOG2)) - SL_COUNT;
+            fl = f - SL_LOG2 + 1;
+        }
+    }
+
+    uint64_t unit() const { return uint64_t(1) << _alignment_pow; }
+    uint8_t* header_ptr(uint64_t b) const { return _base + (b << _alignment_pow); }
+    Header& header(uint64_t b) const { return *std::launder(reinterpret_cast<Header*>(header_ptr(b))); }
+
+    // Finds a free block of at least ``size`` units, in constant time.
+    uint64_t find_free(uint64_t size) const {
+        unsigned fl, sl;
+        // Round up to the next list, so that any block of the found list fits.
+        uint64_t rounded = size;
+        if (size >= SL_COUNT) rounded += (uint64_t(1) << (fls(size) - SL_LOG2)) - 1;
+        mapping(rounded, fl, sl);
+        if (fl >= FL_COUNT) return NIL;
+        uint64_t sl_map = _sl_bitmap[fl] & (~uint64_t(0) << sl);
+        if (sl_map == 0) {
+            const uint64_t fl_map = fl + 1 < 64 ? _fl_bitmap & (~uint64_t(0) << (fl + 1)) : 0;
+            if (fl_map == 0) return NIL;
+            fl = ffs(fl_map);
+            sl_map = _sl_bitmap[fl];
+        }
+        return _free_lists[fl][ffs(sl_map)];
+    }
+
+    void insert_free(uint64_t b) {
+        Header& h = header(b);
+        const uint64_t size = h.size & ~FREE;
+        unsigned fl, sl;
+        mapping(size, fl, sl);
+        h.size = size | FREE;
+        h.prev_free = NIL;
+        h.next_free = _free_lists[fl][sl];
+        if (h.next_free != NIL) header(h.next_free).prev_free = b;
+        _free_lists[fl][sl] = b;
+        _sl_bitmap[fl] |= uint64_t(1) << sl;
+        _fl_bitmap |= uint64_t(1) << fl;
+        _free_units += size;
+        _free_blocks++;
+    }
+
+    void remove_free(uint64_t b) {
+        Header& h = header(b);
+        const uint64_t size = h.size & ~FREE;
+        unsigned fl, sl;
+        mapping(size, fl, sl);
+        if (h.prev_free != NIL) {
+            header(h.prev_free).next_free = h.next_free;
+        } else {
+            _free_lists[fl][sl] = h.next_free;
+            if (h.next_free == NIL) {
+                _sl_bitmap[fl] &= ~(uint64_t(1) << sl);
+                if (_sl_bitmap[fl] == 0) _fl_bitmap &= ~(uint64_t(1) << fl);
+            }
+        }
+        if (h.next_free != NIL) header(h.next_free).prev_free = h.prev_free;
+        h.size = size;
+        _free_units -= size;
+        _free_blocks--;
+    }
+
+    uint8_t* _base = nullptr;
+    SegmentId _segment = 0;
+    uint8_t _alignment_pow = 0;
+    uint64_t _total = 0;
+    uint64_t _fl_bitmap = 0;
+    uint64_t _sl_bitmap[FL_COUNT] = {};
+    uint64_t _free_lists[FL_COUNT][SL_COUNT];
+    uint64_t _free_units = 0;
+    uint64_t _free_blocks = 0;
+    uint64_t _used_blocks = 0;
+};
+}  // namespace detail
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A general purpose backend for ``CppShmProvider``, based on the Two-Level Segregated Fit allocator.
+///
+/// Allocation and deallocation run in bounded time, independent of the number of allocated blocks: a suitable free
+/// block is found with a couple of bit scans, and freed blocks are merged with their free neighbours right away. The
+/// provider thus never needs to defragment, which keeps the allocation latency deterministic for mixed size traffic.
+/// To keep the search constant time, requests are rounded up to the next of the 16 size classes of their power of
+/// two, and may fail while a free block only slightly larger than the request exists. ``available`` reports the total
+/// free space; use ``stats`` to see how fragmented it is and the largest allocation guaranteed to succeed.
+///
+/// Every block carries a header of ``2^alignment_pow`` bytes (at least 32), placed right before its data in the
+/// memory of the backend, and the size of the blocks is rounded up to a multiple of that alignment. The chunk ids of
+/// the allocated chunks are the offsets of their data in the memory of the backend. The backend can allocate its own
+/// memory, usable within the process only, or manage a region provided by the caller, e.g. a shared memory segment
+/// mapped by the ``CppShmClient`` registered for the protocol id of the provider.
+///
+/// This backend is not threadsafe, see ``TlsfShmProviderBackendThreadsafe`` for providers shared between threads.
+class TlsfShmProviderBackend : public CppShmProviderBackend {
+   public:
+    /// @name Constructors
+
+    /// @brief Create a TLSF backend over its own memory.
+    /// @param size size of the memory of the backend, at most 4 GiB.
+    /// @param alignment_pow log2 of the alignment of the chunks, at least 5.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    TlsfShmProviderBackend(size_t size, uint8_t alignment_pow = 6, ZResult* err = nullptr)
+        : _memory(size, alignment_pow < 32 ? alignment_pow : 0) {
+        __ZENOH_RESULT_CHECK(_tlsf.init(_memory.data(), size, 0, alignment_pow), err,
+                             "Failed to create TLSF SHM provider backend: incorrect size or alignment");
+    }
+
+    /// @brief Create a TLSF backend over a memory region provided by the caller.
+    /// @param base start of the region, aligned to ``2^alignment_pow``. It must outlive the backend.
+    /// @param len size of the region, at most 4 GiB.
+    /// @param segment id of the segment, passed in the chunk descriptors.
+    /// @param alignment_pow log2 of the alignment of the chunks, at least 5.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    TlsfShmProviderBackend(uint8_t* base, size_t len, SegmentId segment, uint8_t alignment_pow = 6,
+                           ZResult* err = nullptr) {
+        __ZENOH_RESULT_CHECK(_tlsf.init(base, len, segment, alignment_pow), err,
+                             "Failed to create TLSF SHM provider backend: incorrect memory region or alignment");
+    }
+
+    /// @name Methods
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) override { return _tlsf.alloc(layout); }
+
+    void free(const ChunkDescriptor& chunk) override { _tlsf.free(chunk); }
+
+    size_t defragment() override { return 0; }
+
+    size_t available() const override { return _tlsf.available(); }
+
+    std::optional<ShmOccupancy> occupancy() const override {
+        TlsfStats s = _tlsf.stats();
+        return ShmOccupancy{s.capacity, s.largest_free};
+    }
+
+    void layout_for(MemoryLayout& layout) override {
+        if (!_tlsf.fits(layout)) layout = interop::detail::null<MemoryLayout>();
+    }
+
+    /// @brief Get the statistics of the backend.
+    TlsfStats stats() const { return _tlsf.stats(); }
+
+   private:
+    detail::BackendMemory _memory;
+    detail::TlsfAllocator _tlsf;
+};
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A threadsafe version of ``TlsfShmProviderBackend``, to be used by ``CppShmProvider`` shared between threads.
+///
+/// The backend is owned by the provider: keep a pointer to it before passing it to ``CppShmProvider`` to read its
+/// ``stats`` later on.
+class TlsfShmProviderBackendThreadsafe : public CppShmProviderBackendThreadsafe {
+   public:
+    /// @name Constructors
+
+    /// @brief Create a TLSF backend over its own memory. See ``TlsfShmProviderBackend``.
+    TlsfShmProviderBackendThreadsafe(size_t size, uint8_t alignment_pow = 6, ZResult* err = nullptr)
+        : _backend(size, alignment_pow, err) {}
+
+    /// @brief Create a TLSF backend over a memory region provided by the caller. See ``TlsfShmProviderBackend``.
+    TlsfShmProviderBackendThreadsafe(uint8_t* base, size_t len, SegmentId segment, uint8_t alignment_pow = 6,
+                                     ZResult* err = nullptr)
+        : _backend(base, len, segment, alignment_pow, err) {}
+
+    /// @name Methods
+
+    ChunkAllocResult alloc(const MemoryLayout& layout) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _backend.alloc(layout);
+    }
+
+    void free(const ChunkDescriptor& chunk) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _backend.free(chunk);
+    }
+
+    size_t defragment() override { return 0; }
+
+    size_t available() const override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _backend.available();
+    }
+
+    std::optional<ShmOccupancy> occupancy() const override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _backend.occupancy();
+    }
+
+    void layout_for(MemoryLayout& layout) override { _backend.layout_for(layout); }
+
+    /// @brief Get the statistics of the backend.
+    TlsfStats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _backend.stats();
+    }
+
+   private:
+    mutable std::mutex _mutex;
+    TlsfShmProviderBackend _backend;
+};
+
+}  // end of namespace zenoh
@@ -0,0 +1,237 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "../base.hxx"
+#include "../bytes.hxx"
+#include "../publisher.hxx"
+#include "buffer/zshm.hxx"
+#include "buffer/zshmmut.hxx"
+#include "provider/shm_provider.hxx"
+#include "provider/types.hxx"
+
+namespace zenoh {
+
+/// @warning This API has been marked as unstable: it works as advertised, but it may be changed in a future release.
+/// @brief A publisher recycling a fixed ring of preallocated SHM buffers, so that publishing does not allocate once
+/// the ring is created.
+///
+/// A producer takes a writable buffer with ``acquire`` or ``try_acquire``, fills it and publishes it with ``put``.
+/// The ring keeps a reference to every published buffer, and hands it out again only once all the subscribers and
+/// Zenoh itself dropped theirs, i.e. once the buffer can be turned back into a ``ZShmMut`` (see ``ZShm::try_mutate``).
+/// When no buffer can be reclaimed, the producers outrun the consumers: this is counted as an overrun, and reported
+/// to the ``on_overrun`` callback of the options.
+///
+/// All buffers have the same size, and are published whole. Every acquired buffer must be given back to the ring with
+/// ``put`` or ``release``: a buffer dropped instead is lost to the ring, which then has one buffer less than
+/// ``capacity``. The ring can be used from several threads.
+class ShmRingPublisher {
+   public:
+    /// @brief Options to be passed when constructing ``ShmRingPublisher``.
+    struct ShmRingPublisherOptions {
+        /// @name Fields
+
+        /// @brief Alignment of the buffers.
+        AllocAlignment alignment = AllocAlignment({0});
+        /// @brief Called with the total number of overruns every time no buffer could be reclaimed.
+        std::function<void(uint64_t)> on_overrun;
+
+        /// @name Methods
+
+        /// @brief Create default option settings.
+        static ShmRingPublisherOptions create_default() { return {}; }
+    };
+
+    /// @brief Statistics of the ring.
+    struct Stats {
+        /// @brief Number of buffers published.
+        uint64_t published = 0;
+        /// @brief Number of times a buffer was requested while all of them were still in use.
+        uint64_t overruns = 0;
+        /// @brief Number of buffers published and still referenced by subscribers or Zenoh, as of the last reclaim.
+        size_t in_flight = 0;
+        /// @brief Number of buffers ready to be handed out.
+        size_t free = 0;
+    };
+
+    /// @name Constructors
+
+    /// @brief Create a new ring publisher, allocating all the buffers of the ring.
+    /// @param publisher the publisher to publish the buffers with.
+    /// @param provider the provider to allocate the buffers from. The buffers stay valid if the provider is destroyed.
+    /// @param buffer_size size of the buffers.
+    /// @param buffers_count number of buffers in the ring, at least 1.
+    /// @param options options of the ring.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    ShmRingPublisher(Publisher&& publisher, const ShmProvider& provider, size_t buffer_size, size_t buffers_count,
+                     ShmRingPublisherOptions&& options = ShmRingPublisherOptions::create_default(),
+                     ZResult* err = nullptr)
+        : _publisher(std::move(publisher)), _buffer_size(buffer_size), _on_overrun(std::move(options.on_overrun)) {
+        ZResult res = buffers_count > 0 ? Z_OK : Z_EINVAL;
+        _free.reserve(buffers_count);
+        for (size_t i = 0; i < buffers_count && res == Z_OK; i++) {
+            auto alloc = provider.alloc_gc_defrag(buffer_size, options.alignment);
+            if (std::holds_alternative<ZShmMut>(alloc)) {
+                _free.push_back(std::get<ZShmMut>(std::move(alloc)));
+            } else {
+                res = Z_EINVAL;
+            }
+        }
+        __ZENOH_RESULT_CHECK(res, err, "Failed to create ShmRingPublisher: can not allocate the buffers");
+        if (res != Z_OK) _free.clear();
+        _capacity = _free.size();
+    }
+
+    ShmRingPublisher(const ShmRingPublisher&) = delete;
+    ShmRingPublisher& operator=(const ShmRingPublisher&) = delete;
+
+    /// @name Methods
+
+    /// @brief Take the next writable buffer of the ring, without waiting.
+    /// @return the buffer, or an empty value if all buffers are still in use, which counts as an overrun.
+    std::optional<ZShmMut> try_acquire() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto buf = take();
+        if (!buf.has_value() && _capacity > 0) {
+            uint64_t overruns = ++_overruns;
+            lock.unlock();
+            if (_on_overrun) _on_overrun(overruns);
+        }
+        return buf;
+    }
+
+    /// @brief Take the next writable buffer of the ring, waiting for the subscribers to release one.
+    /// @param timeout maximum time to wait.
+    /// @return the buffer, or an empty value if none was released in time, which counts as an overrun.
+    std::optional<ZShmMut> acquire(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto backoff = std::chrono::microseconds(1);
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto buf = take();
+                if (buf.has_value() || _capacity == 0) return buf;
+            }
+            if (std::chrono::steady_clock::now() + backoff >= deadline) return try_acquire();
+            std::this_thread::sleep_for(backoff);
+            if (backoff < std::chrono::milliseconds(1)) backoff *= 2;
+        }
+    }
+
+    /// @brief Publish a buffer of the ring.
+    /// @param buf a buffer taken from this ring. Buffers which can not come from the ring, i.e. whose size differs
+    /// from ``buffer_size`` or which would exceed ``capacity``, are published without being taken in by the ring nor
+    /// counted in its statistics.
+    /// @param options options to pass to the put operation.
+    /// @param err if not null, the result code will be written to this location, otherwise ZException exception will be
+    /// thrown in case of error.
+    void put(ZShmMut&& buf, Publisher::PutOptions&& options = Publisher::PutOptions::create_default(),
+             ZResult* err = nullptr) {
+        bool own = buf.len() == _buffer_size;
+        ZShm shm(std::move(buf));
+        ZShm kept(shm);
+        ZResult res = Z_OK;
+        _publisher.put(Bytes(std::move(shm)), std::move(options), &res);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!own || !has_room()) {
+                // Not a buffer of the ring, it was only passed through.
+            } else if (res == Z_OK) {
+                _published++;
+                _in_flight.push_back(std::move(kept));
+            } else if (auto mut = ZShm::try_mutate(std::move(kept)); mut.has_value()) {
+                // The buffer was not published, it goes straight back to the ring.
+                _free.push_back(std::move(*mut));
+            } else {
+                _in_flight.push_back(std::move(kept));
+            }
+        }
+        __ZENOH_RESULT_CHECK(res, err, "Failed to publish SHM ring buffer");
+    }
+
+    /// @brief Give back an unpublished buffer to the ring.
+    /// @param buf a buffer taken from this ring. Buffers which can not come from the ring, i.e. whose size differs
+    /// from ``buffer_size`` or which would exceed ``capacity``, are dropped instead.
+    void release(ZShmMut&& buf) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (buf.len() != _buffer_size || !has_room()) return;
+        _free.push_back(std::move(buf));
+    }
+
+    /// @brief Get the statistics of the ring.
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats out;
+        out.published = _published;
+        out.overruns = _overruns;
+        out.in_flight = _in_flight.size();
+        out.free = _free.size();
+        return out;
+    }
+
+    /// @brief Get the size of the buffers.
+    size_t buffer_size() const { return _buffer_size; }
+
+    /// @brief Get the number of buffers of the ring.
+    size_t capacity() const { return _capacity; }
+
+    /// @brief Get the underlying ``Publisher``.
+    const Publisher& publisher() const { return _publisher; }
+
+   private:
+    // Whether a buffer given back to the ring fits in it, i.e. some of its buffers are out.
+    bool has_room() const { return _free.size() + _in_flight.size() < _capacity; }
+
+    // Reclaims the oldest buffer no longer referenced outside of the ring. Subscribers usually release the buffers in
+    // publication order, so the first candidates are the most likely ones.
+    std::optional<ZShmMut> take() {
+        if (!_free.empty()) {
+            ZShmMut buf = std::move(_free.back());
+            _free.pop_back();
+            return buf;
+        }
+        for (auto it = _in_flight.begin(); it != _in_flight.end(); ++it) {
+            // ``try_mutate`` leaves the buffer in place if it is still shared.
+            auto buf = ZShm::try_mutate(std::move(*it));
+            if (buf.has_value()) {
+                _in_flight.erase(it);
+                return buf;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Publisher _publisher;
+    size_t _buffer_size;
+    size_t _capacity = 0;
+    std::function<void(uint64_t)> _on_overrun;
+    mutable std::mutex _mutex;
+    std::vector<ZShmMut> _free;
+    std::list<ZShm> _in_flight;
+    uint64_t _published = 0;
+    uint64_t _overruns = 0;
+};
+
+}  // end of namespace zenoh
@@ -21,8 +21,11 @@
 #pragma once
 
 #include "buffer/buffer.hxx"
+#include "buffer/shm_bytes_writer.hxx"
+#include "buffer/typed_buffer.hxx"
 #include "cleanup.hxx"
 #include "client/client.hxx"
 #include "client_storage/client_storage.hxx"
 #include "protocol_implementations/protocol_implementations.hxx"
-#include "provider/provider.hxx"
\ No newline at end of file
+#include "provider/provider.hxx"
+#include "ring_publisher.hxx"
\ No newline at end of file
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Counts the heap allocations performed on the C++ side of the process, to catch allocation regressions on the hot
+// paths of the header-only library.
+//
+// The header replaces the global `operator new` and `operator delete` and must therefore be included by exactly one
+// translation unit of the test executable. Memory allocated by zenoh-c or zenoh-pico themselves goes through their own
+// allocator and is not counted: the counters only reflect what the C++ wrapper (and the test code) allocates.
+// Counters are global, so allocations made by zenoh threads running C++ callbacks are counted too.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_counter {
+
+/// @brief Number of allocations, deallocations and allocated bytes.
+struct AllocationStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes = 0;
+};
+
+namespace detail {
+inline std::atomic<size_t> allocations = 0;
+inline std::atomic<size_t> deallocations = 0;
+inline std::atomic<size_t> bytes = 0;
+
+inline AllocationStats current() {
+    AllocationStats s;
+    s.allocations = allocations.load();
+    s.deallocations = deallocations.load();
+    s.bytes = bytes.load();
+    return s;
+}
+
+inline void* allocate(std::size_t size, std::size_t alignment) {
+    if (size == 0) size = 1;
+    void* p;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = std::malloc(size);
+    } else {
+#if defined(_WIN32)
+        p = _aligned_malloc(size, alignment);
+#else
+        p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+    if (p != nullptr) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return p;
+}
+
+inline void deallocate(void* p, std::size_t alignment) {
+    if (p == nullptr) return;
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+
+inline void* allocate_or_throw(std::size_t size, std::size_t alignment) {
+    void* p = allocate(size, alignment);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+}  // namespace detail
+
+/// @brief Counts the allocations performed since its construction (or since the last call to ``reset``).
+class AllocationCounter {
+   public:
+    AllocationCounter() : _start(detail::current()) {}
+
+    /// @brief Restart counting from now.
+    void reset() { _start = detail::current(); }
+
+    /// @brief Return the allocations performed since the counter was started.
+    AllocationStats stats() const {
+        AllocationStats now = detail::current();
+        now.allocations -= _start.allocations;
+        now.deallocations -= _start.deallocations;
+        now.bytes -= _start.bytes;
+        return now;
+    }
+
+    size_t allocations() const { return stats().allocations; }
+    size_t deallocations() const { return stats().deallocations; }
+    size_t bytes() const { return stats().bytes; }
+
+   private:
+    AllocationStats _start;
+};
+
+}  // namespace alloc_counter
+
+void* operator new(std::size_t size) { return alloc_counter::detail::allocate_or_throw(size, 0); }
+void* operator new[](std::size_t size) { return alloc_counter::detail::allocate_or_throw(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::allocate(size, 0);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::allocate(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t al) {
+    return alloc_counter::detail::allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    return alloc_counter::detail::allocate_or_throw(size, static_cast<std::size_t>(al));
+}
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::allocate(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return alloc_counter::detail::allocate(size, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* p) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete[](void* p) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete(void* p, std::size_t) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete[](void* p, std::size_t) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc_counter::detail::deallocate(p, 0); }
+void operator delete(void* p, std::align_val_t al) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept {
+    alloc_counter::detail::deallocate(p, static_cast<std::size_t>(al));
+}
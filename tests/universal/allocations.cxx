@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../alloc_counter.hxx"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using alloc_counter::AllocationCounter;
+
+#undef NDEBUG
+#include <assert.h>
+
+void bytes_construction() {
+    const std::vector<uint8_t> data(1024, 42);
+    const std::string str(1024, 'a');
+    {
+        AllocationCounter counter;
+        Bytes b1(data);
+        Bytes b2(str);
+        Bytes b3 = Bytes(std::string_view(str));
+        Bytes b4(str.c_str());
+        Bytes b5 = b1.clone();
+        assert(counter.allocations() == 0);
+    }
+    {
+        // Moving a vector or a string into Bytes keeps the buffer alive in a heap allocated holder,
+        // released by a heap allocated drop closure.
+        std::vector<uint8_t> v = data;
+        std::string s = str;
+        AllocationCounter counter;
+        Bytes b1(std::move(v));
+        assert(counter.allocations() == 2);
+        counter.reset();
+        Bytes b2(std::move(s));
+        assert(counter.allocations() == 2);
+    }
+}
+
+template <class T>
+void serialize_without_allocations(const T& value) {
+    AllocationCounter counter;
+    Bytes b = ext::serialize(value);
+    assert(counter.allocations() == 0);
+}
+
+void serialization() {
+    serialize_without_allocations<uint8_t>(5);
+    serialize_without_allocations<uint64_t>(500000000000);
+    serialize_without_allocations<int32_t>(-50000);
+    serialize_without_allocations<float>(0.5f);
+    serialize_without_allocations<double>(123.45);
+    serialize_without_allocations<bool>(true);
+    serialize_without_allocations(std::string(1024, 'a'));
+    serialize_without_allocations(std::vector<double>(1024, 0.5));
+    serialize_without_allocations(std::vector<std::string>(16, std::string(64, 'b')));
+    serialize_without_allocations(std::map<std::string, int32_t>{{"one", 1}, {"two", 2}, {"three", 3}});
+    serialize_without_allocations(std::unordered_map<int64_t, double>{{1, 1.0}, {2, 2.0}});
+    serialize_without_allocations(std::make_tuple(uint32_t(1), std::string("text"), std::vector<float>(8, 1.0f)));
+    serialize_without_allocations(std::make_pair(std::string("key"), uint16_t(3)));
+}
+
+void deserialization() {
+    Bytes b = ext::serialize(std::vector<double>(1024, 0.5));
+    AllocationCounter counter;
+    auto v = ext::deserialize<std::vector<double>>(b);
+    // A single allocation for the vector storage is expected.
+    assert(counter.allocations() == 1);
+    assert(v.size() == 1024);
+}
+
+void keyexpr() {
+    const std::string key = "zenoh/test/allocations";
+    const KeyExpr prefix("zenoh/test");
+    const KeyExpr suffix("allocations");
+    AllocationCounter counter;
+    {
+        KeyExpr k1(key);
+        KeyExpr k2(key.c_str());
+        KeyExpr k3{std::string_view(key)};
+        KeyExpr k4(std::string_view(key), false);
+        KeyExpr k5 = prefix.concat("/allocations");
+        KeyExpr k6 = prefix.join(suffix);
+        // Error messages are only built when an exception is thrown.
+        ZResult err = Z_OK;
+        KeyExpr k7("zenoh/test/**/**/invalid?", false, &err);
+        assert(err != Z_OK);
+    }
+    assert(counter.allocations() == 0);
+}
+
+int main(int, char**) {
+    bytes_construction();
+    keyexpr();
+    serialization();
+    deserialization();
+}
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <string>
+#include <vector>
+
+#include "zenoh.hxx"
+
+using namespace zenoh;
+
+#undef NDEBUG
+#include <assert.h>
+
+void keyexpr_try_from() {
+    auto k = KeyExpr::try_from("zenoh/test");
+    assert(k.has_value());
+    assert(k);
+    assert(k.error() == Z_OK);
+    assert(k->as_string_view() == "zenoh/test");
+    assert(k.value() == "zenoh/test");
+
+    auto canonized = KeyExpr::try_from("zenoh/**/**/test");
+    assert(canonized.has_value());
+    assert(*canonized == "zenoh/**/test");
+
+    auto invalid = KeyExpr::try_from("zenoh/**/**/test", false);
+    assert(!invalid.has_value());
+    assert(!invalid);
+    assert(invalid.error() != Z_OK);
+
+    bool thrown = false;
+    try {
+        invalid.value();
+    } catch (const ZException& e) {
+        thrown = true;
+        assert(e.e == invalid.error());
+    }
+    assert(thrown);
+}
+
+void keyexpr_try_concat_join() {
+    KeyExpr k("zenoh/test");
+    auto concatenated = k.try_concat("/value");
+    assert(concatenated.has_value());
+    assert(*concatenated == "zenoh/test/value");
+
+    auto joined = k.try_join(KeyExpr("value"));
+    assert(joined.has_value());
+    assert(*joined == "zenoh/test/value");
+
+    auto invalid = KeyExpr("zenoh/**").try_concat("**");
+    assert(!invalid.has_value());
+}
+
+void try_deserialize() {
+    std::vector<int32_t> v = {1, 2, 3};
+    auto res = ext::try_deserialize<std::vector<int32_t>>(ext::serialize(v));
+    assert(res.has_value());
+    assert(*res == v);
+
+    auto moved = std::move(res).value();
+    assert(moved == v);
+
+    auto too_short = ext::try_deserialize<uint64_t>(ext::serialize(uint8_t(1)));
+    assert(!too_short.has_value());
+    auto too_long = ext::try_deserialize<uint8_t>(ext::serialize(uint64_t(1)));
+    assert(!too_long.has_value());
+    assert(too_long.error() == Z_EDESERIALIZE);
+}
+
+void expected_void() {
+    Expected<void> ok;
+    assert(ok.has_value());
+    ok.value();
+
+    auto err = Expected<void>::from_error(Z_EINVAL);
+    assert(!err);
+    assert(err.error() == Z_EINVAL);
+}
+
+int main(int, char**) {
+    keyexpr_try_from();
+    keyexpr_try_concat_join();
+    try_deserialize();
+    expected_void();
+}
@@ -12,6 +12,7 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <mutex>
 #include <thread>
 
 #include "zenoh.hxx"
@@ -180,6 +181,79 @@ void put_sub_ring_channel(Talloc& alloc) {
     assert(std::get<channels::RecvError>(res) == channels::RecvError::Z_DISCONNECTED);
 }
 
+#if defined Z_FEATURE_SHARED_MEMORY && defined Z_FEATURE_UNSTABLE_API
+void put_sub_shm_ring() {
+    KeyExpr ke("zenoh/test");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+
+    PosixShmProvider provider(MemoryLayout(1024 * 1024, AllocAlignment({2})));
+    uint64_t reported_overruns = 0;
+    ShmRingPublisher::ShmRingPublisherOptions options;
+    options.on_overrun = [&reported_overruns](uint64_t overruns) { reported_overruns = overruns; };
+    ShmRingPublisher ring(session1.declare_publisher(ke), provider, 16, 2, std::move(options));
+    assert(ring.capacity() == 2);
+
+    std::mutex mutex;
+    std::vector<std::string> received_messages;
+    auto subscriber = session2.declare_subscriber(
+        ke,
+        [&mutex, &received_messages](const Sample& s) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received_messages.push_back(s.get_payload().as_string());
+        },
+        closures::none);
+
+    std::this_thread::sleep_for(1s);
+
+    // more messages than buffers, the ring recycles them once received
+    for (const char* data : {"first", "second", "third", "fourth"}) {
+        auto buf = ring.acquire(1s);
+        assert(buf.has_value());
+        memset(buf->data(), 0, buf->len());
+        memcpy(buf->data(), data, strlen(data));
+        ring.put(std::move(*buf));
+        std::this_thread::sleep_for(100ms);
+    }
+
+    std::this_thread::sleep_for(1s);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(received_messages.size() == 4);
+        assert(received_messages[3].substr(0, 6) == "fourth");
+    }
+
+    // every buffer held by the producer
+    auto first = ring.acquire(1s);
+    auto second = ring.acquire(1s);
+    assert(first.has_value() && second.has_value());
+    assert(!ring.try_acquire().has_value());
+    assert(reported_overruns == 1);
+    ring.release(std::move(*first));
+    first = ring.try_acquire();
+    assert(first.has_value());
+
+    // buffers which do not come from the ring are not taken in
+    auto foreign = provider.alloc(32, AllocAlignment({2}));
+    assert(std::holds_alternative<ZShmMut>(foreign));
+    ring.release(std::get<ZShmMut>(std::move(foreign)));
+    assert(!ring.try_acquire().has_value());
+    foreign = provider.alloc(32, AllocAlignment({2}));
+    assert(std::holds_alternative<ZShmMut>(foreign));
+    ring.put(std::get<ZShmMut>(std::move(foreign)));
+
+    auto stats = ring.stats();
+    assert(stats.published == 4);
+    assert(stats.overruns == 2);
+    assert(stats.in_flight == 0);
+
+    // acquired buffers are given back, so that the ring keeps all of them
+    ring.release(std::move(*first));
+    ring.release(std::move(*second));
+    assert(ring.stats().free == ring.capacity());
+}
+#endif
+
 template <typename Talloc, bool share_alloc = true>
 void test_with_alloc() {
     if constexpr (share_alloc) {
@@ -213,6 +287,7 @@ int main(int argc, char** argv) {
 #if defined Z_FEATURE_SHARED_MEMORY && defined Z_FEATURE_UNSTABLE_API
     test_with_alloc<SHMAllocator>();
     test_with_alloc<SHMAllocator, false>();
+    put_sub_shm_ring();
 #endif
     return 0;
 }
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../alloc_counter.hxx"
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+using alloc_counter::AllocationCounter;
+
+#undef NDEBUG
+#include <assert.h>
+
+constexpr size_t N = 100;
+
+void wait_for(const std::atomic<size_t>& received, size_t expected) {
+    for (int i = 0; i < 100 && received.load() < expected; i++) {
+        std::this_thread::sleep_for(10ms);
+    }
+}
+
+void publisher_put() {
+    KeyExpr ke("zenoh/test/allocations");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+    auto publisher = session1.declare_publisher(ke);
+
+    std::atomic<size_t> received = 0;
+    auto subscriber = session2.declare_subscriber(
+        ke, [&received](const Sample&) { received++; }, closures::none);
+
+    std::this_thread::sleep_for(1s);
+
+    const std::vector<uint8_t> data(64, 1);
+    // Publication and callback dispatch on the subscriber side.
+    AllocationCounter counter;
+    for (size_t i = 0; i < N; i++) {
+        publisher.put(Bytes(data));
+    }
+    wait_for(received, N);
+    assert(received.load() == N);
+    assert(counter.allocations() == 0);
+}
+
+void session_put() {
+    KeyExpr ke("zenoh/test/allocations");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+
+    std::atomic<size_t> received = 0;
+    auto subscriber = session2.declare_subscriber(
+        ke, [&received](const Sample&) { received++; }, closures::none);
+
+    std::this_thread::sleep_for(1s);
+
+    const std::vector<uint8_t> data(64, 1);
+    AllocationCounter counter;
+    for (size_t i = 0; i < N; i++) {
+        session1.put(ke, Bytes(data));
+    }
+    wait_for(received, N);
+    assert(received.load() == N);
+    assert(counter.allocations() == 0);
+}
+
+template <class Channel>
+void channel_recv(Channel channel) {
+    KeyExpr ke("zenoh/test/allocations");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+    auto publisher = session1.declare_publisher(ke);
+    auto subscriber = session2.declare_subscriber(ke, std::move(channel));
+
+    std::this_thread::sleep_for(1s);
+
+    const std::vector<uint8_t> data(64, 1);
+    for (size_t i = 0; i < N; i++) {
+        publisher.put(Bytes(data));
+    }
+
+    std::this_thread::sleep_for(1s);
+
+    AllocationCounter counter;
+    for (size_t i = 0; i < N; i++) {
+        auto res = subscriber.handler().recv();
+        assert(std::holds_alternative<Sample>(res));
+        assert(std::get<Sample>(res).get_payload().size() == data.size());
+    }
+    auto res = subscriber.handler().try_recv();
+    assert(std::holds_alternative<channels::RecvError>(res));
+    assert(counter.allocations() == 0);
+}
+
+int main(int, char**) {
+    publisher_put();
+    session_put();
+    channel_recv(channels::FifoChannel(N));
+    channel_recv(channels::RingChannel(N));
+}
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+#undef NDEBUG
+#include <assert.h>
+
+void fan_out() {
+    KeyExpr ke("zenoh/test/shared");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+
+    ext::SharedSubscription subscription(session2, ke);
+    assert(subscription.get_keyexpr() == ke);
+
+    std::mutex m;
+    std::vector<ext::SharedSample> received1, received2;
+    subscription.add_consumer([&](const ext::SharedSample& s) {
+        std::lock_guard<std::mutex> lock(m);
+        received1.push_back(s);
+    });
+    auto id2 = subscription.add_consumer([&](const ext::SharedSample& s) {
+        std::lock_guard<std::mutex> lock(m);
+        received2.push_back(s);
+    });
+    auto fifo = subscription.add_channel(16);
+    auto ring = subscription.add_channel(1, ext::SharedSubscription::Backpressure::DropOldest);
+    auto newest = subscription.add_channel(1, ext::SharedSubscription::Backpressure::DropNewest);
+    assert(subscription.consumers() == 5);
+
+    std::this_thread::sleep_for(1s);
+
+    session1.put(ke, Bytes("first"));
+    session1.put(ke, Bytes("second"));
+    session1.put(ke, Bytes("third"));
+
+    std::this_thread::sleep_for(1s);
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        assert(received1.size() == 3);
+        assert(received2.size() == 3);
+        for (size_t i = 0; i < 3; i++) {
+            // all consumers share the same sample
+            assert(received1[i] == received2[i]);
+        }
+        assert(received1[0]->get_payload().as_string() == "first");
+        assert(received1[2]->get_payload().as_string() == "third");
+    }
+
+    for (const char* expected : {"first", "second", "third"}) {
+        auto res = fifo.try_recv();
+        assert(std::holds_alternative<ext::SharedSample>(res));
+        assert(std::get<ext::SharedSample>(res)->get_payload().as_string() == expected);
+    }
+    assert(std::get<channels::RecvError>(fifo.try_recv()) == channels::RecvError::Z_NODATA);
+    assert(fifo.dropped() == 0);
+
+    auto res = ring.try_recv();
+    assert(std::get<ext::SharedSample>(res)->get_payload().as_string() == "third");
+    assert(ring.dropped() == 2);
+
+    res = newest.try_recv();
+    assert(std::get<ext::SharedSample>(res)->get_payload().as_string() == "first");
+    assert(newest.dropped() == 2);
+
+    assert(subscription.remove_consumer(id2));
+    assert(!subscription.remove_consumer(id2));
+    assert(subscription.remove_consumer(ring.id()));
+    assert(subscription.consumers() == 3);
+    assert(std::get<channels::RecvError>(ring.try_recv()) == channels::RecvError::Z_DISCONNECTED);
+
+    session1.put(ke, Bytes("fourth"));
+    std::this_thread::sleep_for(1s);
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        assert(received1.size() == 4);
+        assert(received2.size() == 3);
+    }
+
+    std::move(subscription).undeclare();
+    res = fifo.recv();
+    assert(std::get<ext::SharedSample>(res)->get_payload().as_string() == "fourth");
+    assert(std::get<channels::RecvError>(fifo.recv()) == channels::RecvError::Z_DISCONNECTED);
+}
+
+int main(int, char**) { fan_out(); }
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+#undef NDEBUG
+#include <assert.h>
+
+using Frame = std::vector<float>;
+
+struct Received {
+    std::mutex m;
+    std::vector<std::shared_ptr<const Frame>> values;
+
+    void push(const std::shared_ptr<const Frame>& v) {
+        std::lock_guard<std::mutex> lock(m);
+        values.push_back(v);
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> lock(m);
+        return values.size();
+    }
+};
+
+void typed_pub_sub() {
+    KeyExpr ke("zenoh/test/typed");
+    auto session1 = Session::open(Config::create_default());
+    auto session2 = Session::open(Config::create_default());
+
+    Received local, remote;
+    std::atomic<size_t> raw = 0;
+    ext::TypedSubscriber<Frame> local_sub(session1, ke, [&local](const auto& v) { local.push(v); });
+    ext::TypedSubscriber<Frame> remote_sub(session2, ke, [&remote](const auto& v) { remote.push(v); });
+    auto raw_sub = session2.declare_subscriber(
+        ke,
+        [&raw](const Sample& s) {
+            assert(ext::deserialize<Frame>(s.get_payload()) == Frame({1.0f, 2.0f, 3.0f}));
+            raw++;
+        },
+        closures::none);
+    ext::TypedPublisher<Frame> publisher(session1, ke);
+    assert(publisher.get_keyexpr() == ke);
+
+    std::this_thread::sleep_for(1s);
+
+    auto frame = std::make_shared<const Frame>(Frame{1.0f, 2.0f, 3.0f});
+    publisher.put(frame);
+
+    std::this_thread::sleep_for(1s);
+
+    assert(local.size() == 1);
+    assert(*local.values[0] == *frame);
+    if (ext::TypedPublisher<Frame>::local_delivery) {
+        // delivered without copy to the subscriber of the same session
+        assert(local.values[0] == frame);
+    }
+    assert(remote.size() == 1);
+    assert(*remote.values[0] == *frame);
+    assert(raw == 1);
+
+    std::move(local_sub).undeclare();
+    publisher.put(Frame{1.0f, 2.0f, 3.0f});
+
+    std::this_thread::sleep_for(1s);
+
+    assert(local.size() == 1);
+    assert(remote.size() == 2);
+    assert(raw == 2);
+}
+
+int main(int, char**) { typed_pub_sub(); }
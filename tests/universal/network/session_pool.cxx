@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zenoh.hxx"
+
+using namespace zenoh;
+using namespace std::chrono_literals;
+
+#undef NDEBUG
+#include <assert.h>
+
+constexpr size_t POOL_SIZE = 3;
+constexpr size_t KEYS = 12;
+
+void slots() {
+    auto pool = ext::SessionPool::open(Config::create_default(), POOL_SIZE);
+    assert(pool.size() == POOL_SIZE);
+    for (size_t i = 0; i < KEYS; i++) {
+        KeyExpr ke("zenoh/test/pool/" + std::to_string(i));
+        size_t slot = pool.slot_for(ke);
+        assert(slot < POOL_SIZE);
+        assert(slot == pool.slot_for(KeyExpr("zenoh/test/pool/" + std::to_string(i))));
+        assert(pool.session_for(ke).get_zid().bytes() == pool.session(slot).get_zid().bytes());
+    }
+    assert(pool.session(0).get_zid().bytes() != pool.session(1).get_zid().bytes());
+
+    ZResult err = Z_OK;
+    ext::SessionPool empty(Config::create_default(), 0, &err);
+    assert(err != Z_OK);
+    assert(empty.size() == 0);
+}
+
+void put_sub() {
+    auto pool = ext::SessionPool::open(Config::create_default(), POOL_SIZE);
+    auto session = Session::open(Config::create_default());
+
+    std::atomic<size_t> received = 0;
+    auto subscriber = session.declare_subscriber(
+        KeyExpr("zenoh/test/pool/**"), [&received](const Sample&) { received++; }, closures::none);
+
+    std::vector<Publisher> publishers;
+    std::vector<size_t> expected_puts(POOL_SIZE, 0);
+    std::vector<size_t> expected_publishers(POOL_SIZE, 0);
+    for (size_t i = 0; i < KEYS; i++) {
+        KeyExpr ke("zenoh/test/pool/" + std::to_string(i));
+        publishers.push_back(pool.declare_publisher(ke));
+        expected_puts[pool.slot_for(ke)]++;
+        expected_publishers[pool.slot_for(ke)]++;
+    }
+
+    std::this_thread::sleep_for(1s);
+
+    for (size_t i = 0; i < KEYS; i++) {
+        pool.put(KeyExpr("zenoh/test/pool/" + std::to_string(i)), Bytes("data"));
+        publishers[i].put(Bytes("data"));
+    }
+
+    std::this_thread::sleep_for(1s);
+
+    assert(received == 2 * KEYS);
+    auto stats = pool.stats();
+    assert(stats.size() == POOL_SIZE);
+    size_t puts = 0;
+    for (size_t slot = 0; slot < POOL_SIZE; slot++) {
+        assert(stats[slot].puts == expected_puts[slot]);
+        assert(stats[slot].put_bytes == 4 * expected_puts[slot]);
+        assert(stats[slot].put_errors == 0);
+        assert(stats[slot].publishers == expected_publishers[slot]);
+        assert(stats[slot].subscribers == 0);
+        puts += stats[slot].puts;
+    }
+    assert(puts == KEYS);
+}
+
+void pool_subscriber() {
+    auto pool = ext::SessionPool::open(Config::create_default(), POOL_SIZE);
+    auto session = Session::open(Config::create_default());
+    KeyExpr ke("zenoh/test/pool/sub");
+
+    auto subscriber = pool.declare_subscriber(ke, channels::FifoChannel(16));
+    assert(pool.stats(pool.slot_for(ke)).subscribers == 1);
+
+    std::this_thread::sleep_for(1s);
+
+    session.put(ke, Bytes("data"));
+
+    std::this_thread::sleep_for(1s);
+
+    auto res = subscriber.handler().try_recv();
+    assert(std::holds_alternative<Sample>(res));
+    assert(std::get<Sample>(res).get_payload().as_string() == "data");
+
+    pool.close();
+}
+
+int main(int, char**) {
+    slots();
+    put_sub();
+    pool_subscriber();
+}
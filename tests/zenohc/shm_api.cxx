@@ -12,6 +12,8 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <future>
+#include <memory_resource>
 #include <thread>
 #include <unordered_set>
 
@@ -240,6 +242,405 @@ int run_c_provider() {
     return Z_OK;
 }
 
+// Selects the CppShmProvider constructor matching the backend.
+template <class Backend>
+auto into_backend_ptr(std::unique_ptr<Backend> backend) {
+    using Base = std::conditional_t<std::is_base_of_v<CppShmProviderBackendThreadsafe, Backend>,
+                                    CppShmProviderBackendThreadsafe, CppShmProviderBackend>;
+    return std::unique_ptr<Base>(std::move(backend));
+}
+
+template <class Backend>
+int run_slab_provider_impl() {
+    const ProtocolId id = 100501;
+
+    // test common provider functionality
+    {
+        CppShmProvider provider(id, into_backend_ptr(std::make_unique<Backend>(std::vector<SlabSizeClass>{{1024, 4}})));
+        ASSERT_OK(test_provider(provider, AllocAlignment({0}), 1024, 0));
+    }
+
+    // test size classes
+    const std::vector<SlabSizeClass> classes = {{1024, 2}, {64, 4}};
+    CppShmProvider provider(id, into_backend_ptr(std::make_unique<Backend>(classes)));
+    ASSERT_TRUE(provider.available() == 64 * 4 + 1024 * 2);
+
+    std::vector<ZShmMut> bufs;
+    for (int i = 0; i < 6; ++i) {
+        // once the 64 bytes class is exhausted, the 1024 bytes class is used
+        auto alloc = provider.alloc(64, AllocAlignment({0}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+        bufs.push_back(std::get<ZShmMut>(std::move(alloc)));
+    }
+    ASSERT_TRUE(provider.available() == 0);
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(provider.alloc(64, AllocAlignment({0}))));
+
+    // chunks are aligned on 64 bytes by default
+    for (const auto& buf : bufs) {
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(buf.data()) % 64 == 0);
+    }
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(provider.alloc(64, AllocAlignment({7}))));
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(provider.alloc(2048, AllocAlignment({0}))));
+
+    bufs.clear();
+    provider.garbage_collect();
+    ASSERT_TRUE(provider.available() == 64 * 4 + 1024 * 2);
+
+    return Z_OK;
+}
+
+int run_slab_provider() {
+    ASSERT_OK(run_slab_provider_impl<SlabShmProviderBackend>());
+    ASSERT_OK(run_slab_provider_impl<SlabShmProviderBackendThreadsafe>());
+
+    ZResult err = Z_OK;
+    SlabShmProviderBackend empty(std::vector<SlabSizeClass>{}, 6, &err);
+    ASSERT_TRUE(err != Z_OK);
+    return Z_OK;
+}
+
+template <class Backend>
+int run_tlsf_provider_impl() {
+    const ProtocolId id = 100502;
+
+    // test common provider functionality
+    {
+        CppShmProvider provider(id, into_backend_ptr(std::make_unique<Backend>(64 * 1024)));
+        ASSERT_OK(test_provider(provider, AllocAlignment({0}), 1024, 1024 * 1024));
+    }
+
+    // test coalescing: 256 units of 64 bytes, every block has a one unit header
+    auto backend = std::make_unique<Backend>(16 * 1024);
+    auto tlsf = backend.get();
+    CppShmProvider provider(id, into_backend_ptr(std::move(backend)));
+    const size_t capacity = 255 * 64;
+    auto stats = tlsf->stats();
+    ASSERT_TRUE(stats.capacity == capacity);
+    ASSERT_TRUE(stats.free == capacity);
+    ASSERT_TRUE(stats.largest_free == capacity);
+    ASSERT_TRUE(stats.free_blocks == 1);
+    ASSERT_TRUE(stats.fragmentation() == 0.0);
+
+    std::vector<ZShmMut> bufs;
+    for (int i = 0; i < 3; ++i) {
+        auto alloc = provider.alloc(4000, AllocAlignment({0}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+        bufs.push_back(std::get<ZShmMut>(std::move(alloc)));
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(bufs.back().data()) % 64 == 0);
+    }
+    ASSERT_TRUE(tlsf->stats().used_blocks == 3);
+    ASSERT_TRUE(provider.available() == 63 * 64);
+
+    // free the middle block: two free blocks of 63 usable units, separated by an allocated one
+    bufs.erase(bufs.begin() + 1);
+    provider.garbage_collect();
+    stats = tlsf->stats();
+    ASSERT_TRUE(stats.free_blocks == 2);
+    ASSERT_TRUE(stats.free == 2 * 63 * 64);
+    ASSERT_TRUE(stats.largest_free == 63 * 64);
+    ASSERT_TRUE(stats.fragmentation() == 0.5);
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(provider.alloc(5000, AllocAlignment({0}))));
+
+    // freed blocks merge back into a single one
+    bufs.clear();
+    provider.garbage_collect();
+    stats = tlsf->stats();
+    ASSERT_TRUE(stats.free_blocks == 1);
+    ASSERT_TRUE(stats.used_blocks == 0);
+    ASSERT_TRUE(stats.free == capacity);
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(provider.alloc(capacity, AllocAlignment({0}))));
+
+    return Z_OK;
+}
+
+int run_tlsf_provider() {
+    ASSERT_OK(run_tlsf_provider_impl<TlsfShmProviderBackend>());
+    ASSERT_OK(run_tlsf_provider_impl<TlsfShmProviderBackendThreadsafe>());
+
+    ZResult err = Z_OK;
+    TlsfShmProviderBackend misaligned(1024, 2, &err);
+    ASSERT_TRUE(err != Z_OK);
+    return Z_OK;
+}
+
+int run_provider_stats() {
+    auto backend = std::make_unique<TlsfShmProviderBackendThreadsafe>(16 * 1024);
+    const CppShmProviderBackendIface* iface = backend.get();
+    CppShmProvider provider(100503, into_backend_ptr(std::move(backend)));
+
+    // occupancy is reported by the backend, only the operations done through the collector are counted
+    ShmProviderStatsCollector::ShmProviderStatsCollectorOptions options;
+    options.backend = iface;
+    ShmProviderStatsCollector collector(provider, std::move(options));
+    auto stats = collector.stats();
+    ASSERT_TRUE(stats.total == 255 * 64);
+    ASSERT_TRUE(stats.used() == 0);
+    ASSERT_TRUE(stats.largest_free == 255 * 64);
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(provider.alloc(1024, AllocAlignment({0}))));
+    ASSERT_TRUE(collector.stats().allocation_count(AllocPolicy::Alloc) == 0);
+    provider.garbage_collect();
+    ASSERT_TRUE(collector.stats().gc_runs == 0);
+
+    // every block takes 64 units of 64 bytes with its header, so only 3 of them fit in 255 units
+    AllocLayout layout(provider, 4000, AllocAlignment({0}));
+    AllocLayoutStatsCollector layout_collector(layout, &collector);
+    std::vector<ZShmMut> bufs;
+    for (int i = 0; i < 4; ++i) {
+        auto alloc = layout_collector.alloc();
+        if (std::holds_alternative<ZShmMut>(alloc)) bufs.push_back(std::get<ZShmMut>(std::move(alloc)));
+    }
+    ASSERT_TRUE(bufs.size() == 3);
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(collector.alloc_gc(8000, AllocAlignment({0}))));
+    stats = collector.stats();
+    ASSERT_TRUE(stats.allocation_count(AllocPolicy::Alloc) == 4);
+    ASSERT_TRUE(stats.allocation_count(AllocPolicy::Gc) == 1);
+    ASSERT_TRUE(stats.failure_count() == 2);
+    ASSERT_TRUE(stats.alloc_latency.count() == 5);
+    ASSERT_TRUE(stats.used() == 3 * 64 * 64);
+
+    auto layout_stats = layout_collector.stats();
+    ASSERT_TRUE(layout_stats.allocation_count(AllocPolicy::Alloc) == 4);
+    ASSERT_TRUE(layout_stats.allocation_count(AllocPolicy::Gc) == 0);
+    ASSERT_FALSE(layout_stats.total.has_value());
+
+    bufs.clear();
+    collector.garbage_collect();
+    collector.defragment();
+    stats = collector.stats();
+    ASSERT_TRUE(stats.gc_runs == 1);
+    ASSERT_TRUE(stats.defrag_runs == 1);
+    ASSERT_TRUE(stats.used() == 0);
+
+    size_t metrics = 0;
+    stats.for_each_metric([&](std::string_view, uint64_t) { metrics++; });
+    ASSERT_TRUE(metrics > 0);
+    return Z_OK;
+}
+
+struct Point {
+    float x, y, z;
+    uint32_t rgb;
+};
+
+int run_typed_buffers() {
+    CppShmProvider provider(100504, into_backend_ptr(std::make_unique<TlsfShmProviderBackendThreadsafe>(64 * 1024)));
+
+    // arrays are allocated with the alignment of the element type
+    auto layout = ShmArray<Point>::create_layout(provider, 100);
+    auto array_alloc = ShmArray<Point>::from(layout.alloc_gc());
+    ASSERT_TRUE(std::holds_alternative<ShmArray<Point>>(array_alloc));
+    auto points = std::get<ShmArray<Point>>(std::move(array_alloc));
+    ASSERT_TRUE(points.size() == 100);
+    ASSERT_TRUE(reinterpret_cast<uintptr_t>(points.data()) % alignof(Point) == 0);
+    for (size_t i = 0; i < points.size(); ++i) points[i] = Point{float(i), 0.0f, 0.0f, uint32_t(i)};
+    ShmSpan<const Point> tail = points.span().subspan(90, 20);
+    ASSERT_TRUE(tail.size() == 10);
+    ASSERT_TRUE(tail[0].rgb == 90);
+
+    // the receiving side gets a read-only view of the same memory
+    Bytes payload(std::move(points).release());
+    ShmArrayView<Point> view(payload);
+    ASSERT_TRUE(view.size() == 100);
+    ASSERT_TRUE(view[42].x == 42.0f);
+
+    // single objects
+    auto object_layout = ShmObject<uint64_t>::create_layout(provider);
+    auto object_alloc = ShmObject<uint64_t>::from(object_layout.alloc());
+    ASSERT_TRUE(std::holds_alternative<ShmObject<uint64_t>>(object_alloc));
+    auto& counter = std::get<ShmObject<uint64_t>>(object_alloc);
+    *counter = 7;
+    ShmArrayView<uint64_t> counter_view(ZShm(std::move(counter).release()));
+    ASSERT_TRUE(counter_view.size() == 1 && counter_view[0] == 7);
+
+    // partial elements are rejected
+    auto odd = provider.alloc(10, AllocAlignment({2}));
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(odd));
+    ZResult err = Z_OK;
+    ShmArray<uint32_t> rejected(std::get<ZShmMut>(std::move(odd)), &err);
+    ASSERT_TRUE(err != Z_OK);
+    ASSERT_TRUE(rejected.size() == 0);
+    return Z_OK;
+}
+
+int run_memory_resource() {
+    CppShmProvider provider(100505, into_backend_ptr(std::make_unique<TlsfShmProviderBackendThreadsafe>(64 * 1024)));
+    ShmMemoryResource resource(provider);
+    {
+        std::pmr::vector<uint32_t> values(&resource);
+        for (uint32_t i = 0; i < 1000; ++i) values.push_back(i);
+        ASSERT_TRUE(resource.allocation_count() == 1);
+        ASSERT_TRUE(resource.owns(values.data()));
+
+        // the element storage is published as is
+        auto shm = resource.share(values.data());
+        ASSERT_TRUE(shm.has_value());
+        ASSERT_TRUE(shm->data() == reinterpret_cast<const uint8_t*>(values.data()));
+        ASSERT_TRUE(shm->len() >= values.size() * sizeof(uint32_t));
+        ASSERT_TRUE(reinterpret_cast<const uint32_t*>(shm->data())[999] == 999);
+
+        uint32_t not_allocated = 0;
+        ASSERT_FALSE(resource.share(&not_allocated).has_value());
+    }
+    ASSERT_TRUE(resource.allocation_count() == 0);
+    ASSERT_TRUE(resource.allocated_bytes() == 0);
+
+    // exhausting the provider fails like any other memory resource
+    bool thrown = false;
+    try {
+        static_cast<void>(resource.allocate(1024 * 1024));
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+    return Z_OK;
+}
+
+int run_shm_bytes_writer() {
+    CppShmProvider provider(100506, into_backend_ptr(std::make_unique<TlsfShmProviderBackendThreadsafe>(64 * 1024)));
+
+    std::vector<uint8_t> data(5000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = uint8_t(i * 7);
+
+    ShmBytesWriter::ShmBytesWriterOptions options;
+    options.initial_chunk_size = 1024;
+    options.max_chunk_size = 2048;
+    ShmBytesWriter writer(provider, std::move(options));
+    writer.write_all(data.data(), 1000);
+    // write in place, as an encoder would
+    auto buf = writer.next_buffer();
+    ASSERT_TRUE(buf.size() == 24);
+    memcpy(buf.data(), data.data() + 1000, buf.size());
+    writer.commit(buf.size());
+    writer.write_all(data.data() + 1024, data.size() - 1024);
+    ASSERT_TRUE(writer.size() == data.size());
+    ASSERT_TRUE(writer.chunk_count() == 3);
+
+    // 1024 + 2048 + 2048 bytes chunks, the tail of the last one is trimmed
+    Bytes bytes = std::move(writer).finish();
+    ASSERT_TRUE(bytes.size() == data.size());
+    ASSERT_TRUE(bytes.as_vector() == data);
+    size_t slices = 0;
+    auto it = bytes.slice_iter();
+    for (auto slice = it.next(); slice.has_value(); slice = it.next()) slices++;
+    ASSERT_TRUE(slices == 3);
+
+    // compaction produces a single SHM buffer
+    ShmBytesWriter::ShmBytesWriterOptions compact_options;
+    compact_options.initial_chunk_size = 1024;
+    compact_options.compact = true;
+    ShmBytesWriter compact_writer(provider, std::move(compact_options));
+    compact_writer.write_all(data.data(), data.size());
+    Bytes compacted = std::move(compact_writer).finish();
+    ZResult err = Z_OK;
+    ZShm shm = compacted.as_shm(&err);
+    ASSERT_OK(err);
+    ASSERT_TRUE(shm.len() == data.size());
+    ASSERT_TRUE(memcmp(shm.data(), data.data(), data.size()) == 0);
+
+    // nothing written, nothing allocated
+    ShmBytesWriter empty_writer(provider);
+    ASSERT_TRUE(std::move(empty_writer).finish().size() == 0);
+    return Z_OK;
+}
+
+int run_async_alloc() {
+    CppShmProvider provider(100507, into_backend_ptr(std::make_unique<TlsfShmProviderBackendThreadsafe>(64 * 1024)));
+
+    auto future = provider.alloc_gc_defrag_async(1024, AllocAlignment({4}));
+    auto result = future.get();
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(result));
+    ASSERT_TRUE(std::get<ZShmMut>(result).len() == 1024);
+
+    std::promise<size_t> received;
+    ASSERT_OK(provider.alloc_gc_defrag_async(512, AllocAlignment({4}), [&received](BufLayoutAllocResult&& r) {
+        received.set_value(std::holds_alternative<ZShmMut>(r) ? std::get<ZShmMut>(r).len() : 0);
+    }));
+    ASSERT_TRUE(received.get_future().get() == 512);
+
+    AllocLayout layout(provider, 256, AllocAlignment({4}));
+    auto layout_result = layout.alloc_gc_defrag_async().get();
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(layout_result));
+
+    std::promise<bool> layout_received;
+    ASSERT_OK(layout.alloc_gc_defrag_async([&layout_received](BufAllocResult&& r) {
+        layout_received.set_value(std::holds_alternative<ZShmMut>(r));
+    }));
+    ASSERT_TRUE(layout_received.get_future().get());
+
+    // too large for the provider
+    auto failed = provider.alloc_gc_defrag_async(1024 * 1024, AllocAlignment({4})).get();
+    ASSERT_FALSE(std::holds_alternative<ZShmMut>(failed));
+    return Z_OK;
+}
+
+int run_provider_maintenance() {
+    CppShmProvider provider(100508, into_backend_ptr(std::make_unique<TlsfShmProviderBackendThreadsafe>(16 * 1024)));
+    const size_t initial = provider.available();
+
+    // fill the provider and drop the buffers: they are only reclaimed by garbage collection
+    for (int i = 0; i < 12; i++) {
+        auto buf = provider.alloc(1024, AllocAlignment({4}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(buf));
+    }
+
+    ShmProviderMaintenance::ShmProviderMaintenanceOptions options;
+    options.gc_watermark = 0.25;
+    ShmProviderMaintenance maintenance(provider, std::move(options));
+    for (int i = 0; i < 100 && provider.available() < initial; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(provider.available() == initial);
+    auto stats = maintenance.stats();
+    ASSERT_TRUE(stats.polls > 0);
+    ASSERT_TRUE(stats.gc_runs > 0);
+    ASSERT_TRUE(stats.collected > 0);
+
+    // once collected, the idle provider is left alone
+    auto gc_runs = stats.gc_runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(maintenance.stats().gc_runs == gc_runs);
+    maintenance.wake();
+
+    // buffers released by the readers of an idle provider are reclaimed without waking the maintenance
+    auto backend = std::make_unique<TlsfShmProviderBackendThreadsafe>(16 * 1024);
+    ShmProviderStatsCollector::ShmProviderStatsCollectorOptions collector_options;
+    collector_options.backend = backend.get();
+    CppShmProvider held_provider(100509, into_backend_ptr(std::move(backend)));
+    const size_t held_initial = held_provider.available();
+    ShmProviderStatsCollector collector(held_provider, std::move(collector_options));
+    std::vector<ZShmMut> held;
+    for (int i = 0; i < 12; i++) {
+        auto buf = held_provider.alloc(1024, AllocAlignment({4}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(buf));
+        held.push_back(std::get<ZShmMut>(std::move(buf)));
+    }
+    ShmProviderMaintenance::ShmProviderMaintenanceOptions held_options;
+    held_options.gc_watermark = 0.25;
+    held_options.defrag_watermark = 0.5;
+    held_options.max_interval = std::chrono::milliseconds(20);
+    ShmProviderMaintenance held_maintenance(collector, std::move(held_options));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto held_stats = held_maintenance.stats();
+    ASSERT_TRUE(held_stats.gc_runs > 0);
+    ASSERT_TRUE(held_stats.collected == 0);
+    ASSERT_TRUE(held_provider.available() < held_initial);
+
+    held.clear();
+    for (int i = 0; i < 100 && held_provider.available() < held_initial; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(held_provider.available() == held_initial);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    held_stats = held_maintenance.stats();
+    ASSERT_TRUE(held_stats.collected > 0);
+    ASSERT_TRUE(collector.stats().gc_runs == held_stats.gc_runs);
+
+    // once below the watermark, collection stops
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(held_maintenance.stats().gc_runs == held_stats.gc_runs);
+    return Z_OK;
+}
+
 int run_posix_provider() {
     const size_t total_size = 4096;
     const size_t buf_ok_size = total_size / 4;
@@ -253,6 +654,18 @@ int run_posix_provider() {
     PosixShmProvider provider(layout);
     ASSERT_OK(test_provider(provider, alignment, buf_ok_size, buf_err_size));
 
+    // the whole segment is given back to the provider after prefaulting
+    PosixShmProvider prefaulted(layout, PosixShmProvider::PosixShmProviderOptions{true, false});
+    ASSERT_TRUE(prefaulted.available() == provider.available());
+    ASSERT_OK(test_provider(prefaulted, alignment, buf_ok_size, buf_err_size));
+
+    // locking depends on RLIMIT_MEMLOCK
+    ZResult err = Z_OK;
+    PosixShmProvider locked(layout, PosixShmProvider::PosixShmProviderOptions{false, true}, &err);
+    if (err == Z_OK) {
+        ASSERT_OK(test_provider(locked, alignment, buf_ok_size, buf_err_size));
+    }
+
     return Z_OK;
 }
 
@@ -266,6 +679,127 @@ int test_client_storage(const ShmClientStorage& storage) {
     return Z_OK;
 }
 
+#if defined(__linux__)
+int run_hugepage_provider() {
+    // the segment is rounded up to at least 2 MiB
+    HugePageShmProvider provider(1024 * 1024);
+    ASSERT_OK(test_provider(provider, AllocAlignment({0}), 1024, 4 * 1024 * 1024));
+
+    // the client maps the segment of the provider, the first buffer follows a 64 bytes header
+    auto alloc = provider.alloc(1024, AllocAlignment({0}));
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+    auto buf = std::get<ZShmMut>(std::move(alloc));
+    buf.data()[0] = 42;
+    const std::string dir = provider.uses_huge_pages() ? "/dev/hugepages" : "/dev/shm";
+    auto mapping = detail::open_hugepage_segment(dir, provider.segment_id(), 0);
+    ASSERT_TRUE(mapping.data() != nullptr);
+    ASSERT_TRUE(mapping.at(64)[0] == 42);
+
+    HugePageShmClient::HugePageShmClientOptions client_options;
+    client_options.prefault = true;
+    std::vector<std::pair<ProtocolId, ShmClient>> list;
+    list.push_back(std::make_pair(HugePageShmProvider::PROTOCOL_ID, HugePageShmClient(std::move(client_options))));
+    ASSERT_OK(test_client_storage(ShmClientStorage(std::move(list), true)));
+
+    // a prefaulted segment
+    HugePageShmProvider::HugePageShmProviderOptions prefault_options;
+    prefault_options.prefault = true;
+    HugePageShmProvider prefaulted(1024 * 1024, std::move(prefault_options));
+    ASSERT_OK(test_provider(prefaulted, AllocAlignment({0}), 1024, 4 * 1024 * 1024));
+
+    // without fallback, the provider fails when there is no hugetlbfs at the given path
+    HugePageShmProvider::HugePageShmProviderOptions options;
+    options.hugetlbfs_path = "/dev/shm";
+    options.allow_fallback = false;
+    ZResult err = Z_OK;
+    HugePageShmProvider failed(1024 * 1024, std::move(options), &err);
+    ASSERT_TRUE(err != Z_OK);
+    return Z_OK;
+}
+
+int run_memfd_provider() {
+    MemfdShmProvider provider(1024 * 1024);
+    ASSERT_OK(test_provider(provider, AllocAlignment({0}), 1024, 4 * 1024 * 1024));
+
+    // the segment is received from the rendezvous socket of the provider, the first buffer follows a 64 bytes header
+    auto alloc = provider.alloc(1024, AllocAlignment({0}));
+    ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+    auto buf = std::get<ZShmMut>(std::move(alloc));
+    buf.data()[0] = 42;
+    auto mapping = detail::open_memfd_segment(provider.segment_id(), 0, true);
+    ASSERT_TRUE(mapping.size() == 1024 * 1024);
+    ASSERT_TRUE(mapping.at(64)[0] == 42);
+
+    // unsealed segments are rejected when seals are required
+    SegmentId id;
+    {
+        MemfdShmProvider::MemfdShmProviderOptions options;
+        options.seal = false;
+        MemfdShmProvider unsealed(1024 * 1024, std::move(options));
+        id = unsealed.segment_id();
+        ASSERT_TRUE(detail::open_memfd_segment(id, 0, true).data() == nullptr);
+        ASSERT_TRUE(detail::open_memfd_segment(id, 0, false).data() != nullptr);
+    }
+
+    // nothing is left once the provider is dropped
+    ASSERT_TRUE(detail::open_memfd_segment(id, 0, false).data() == nullptr);
+
+    std::vector<std::pair<ProtocolId, ShmClient>> list;
+    list.push_back(std::make_pair(MemfdShmProvider::PROTOCOL_ID, MemfdShmClient()));
+    ASSERT_OK(test_client_storage(ShmClientStorage(std::move(list), true)));
+    return Z_OK;
+}
+#endif
+
+int run_slab_thread_cache() {
+    auto backend = std::make_unique<SlabShmProviderBackendThreadsafe>(
+        std::vector<SlabSizeClass>{{64, 16}}, 6,
+        SlabShmProviderBackendThreadsafe::SlabShmProviderBackendThreadsafeOptions{4, 8});
+    auto* slab = backend.get();
+    CppShmProvider provider(100510, into_backend_ptr(std::move(backend)));
+
+    // the first allocation takes a batch of chunks from the slab, the next ones are served from the thread cache
+    std::vector<ZShmMut> bufs;
+    for (int i = 0; i < 4; ++i) {
+        auto alloc = provider.alloc(64, AllocAlignment({0}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+        bufs.push_back(std::get<ZShmMut>(std::move(alloc)));
+    }
+    auto stats = slab->stats();
+    ASSERT_TRUE(stats.misses == 1);
+    ASSERT_TRUE(stats.hits == 3);
+    ASSERT_TRUE(stats.refilled == 4);
+
+    // collected chunks come back to the cache of the collecting thread, and are counted as available
+    bufs.clear();
+    provider.garbage_collect();
+    ASSERT_TRUE(provider.available() == 16 * 64);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(provider.alloc(64, AllocAlignment({0}))));
+    }
+    ASSERT_TRUE(slab->stats().hits == 7);
+    provider.garbage_collect();
+
+    // chunks cached by another thread are reclaimed once the slab is exhausted
+    std::thread t([&provider]() {
+        auto alloc = provider.alloc(64, AllocAlignment({0}));
+        assert(std::holds_alternative<ZShmMut>(alloc));
+    });
+    t.join();
+    provider.garbage_collect();
+    for (int i = 0; i < 16; ++i) {
+        auto alloc = provider.alloc(64, AllocAlignment({0}));
+        ASSERT_TRUE(std::holds_alternative<ZShmMut>(alloc));
+        bufs.push_back(std::get<ZShmMut>(std::move(alloc)));
+    }
+    ASSERT_TRUE(provider.available() == 0);
+    auto all = slab->stats_all();
+    ASSERT_TRUE(all.size() == 2);
+    ASSERT_TRUE(all[1].misses == 1);
+    ASSERT_TRUE(all[1].flushed > 0);
+    return Z_OK;
+}
+
 int run_default_client_storage() {
     ShmClientStorage storage;
 
@@ -366,6 +900,57 @@ int run_c_client() {
     return Z_OK;
 }
 
+class SizedTestShmClient : public CppShmClient {
+   public:
+    size_t attaches = 0;
+
+   private:
+    class Segment : public TestShmSegment {
+       public:
+        using TestShmSegment::TestShmSegment;
+        size_t size() const override { return 1024; }
+    };
+
+    virtual std::unique_ptr<CppShmSegment> attach(SegmentId segment_id) override {
+        attaches++;
+        if (segment_id == 0) return nullptr;
+        return std::make_unique<Segment>(segment_id);
+    }
+};
+
+int run_cached_client() {
+    // segments are attached once, and the least recently used ones are unmapped beyond the budget
+    auto inner = std::make_unique<SizedTestShmClient>();
+    auto* test_client = inner.get();
+    ShmSegmentCache::ShmSegmentCacheOptions options;
+    options.max_bytes = 2 * 1024;
+    auto [client, cache] = ShmSegmentCache::make_client(std::move(inner), std::move(options));
+    ASSERT_TRUE(cache->prefetch(1));
+    ASSERT_TRUE(cache->prefetch(2));
+    ASSERT_TRUE(cache->prefetch(1));
+    ASSERT_TRUE(test_client->attaches == 2);
+    ASSERT_TRUE(cache->prefetch(3));
+    ASSERT_TRUE(cache->contains(1));
+    ASSERT_FALSE(cache->contains(2));
+    ASSERT_TRUE(cache->contains(3));
+    ASSERT_FALSE(cache->prefetch(0));
+
+    auto stats = cache->stats();
+    ASSERT_TRUE(stats.prefetched == 3);
+    ASSERT_TRUE(stats.evictions == 1);
+    ASSERT_TRUE(stats.failures == 1);
+    ASSERT_TRUE(stats.segments == 2);
+    ASSERT_TRUE(stats.bytes == 2 * 1024);
+    ASSERT_TRUE(stats.attach_latency.count() == 3);
+
+    // the cached client is used like any other client
+    std::vector<std::pair<ProtocolId, ShmClient>> list;
+    list.push_back(std::make_pair(ProtocolId(100500), std::move(client)));
+    auto storage = ShmClientStorage(std::move(list), true);
+    ASSERT_OK(test_client_storage(storage));
+    return Z_OK;
+}
+
 int run_cleanup() {
     cleanup_orphaned_shm_segments();
     return Z_OK;
@@ -374,10 +959,24 @@ int run_cleanup() {
 int main() {
     ASSERT_OK(run_posix_provider());
     ASSERT_OK(run_c_provider());
+    ASSERT_OK(run_slab_provider());
+    ASSERT_OK(run_tlsf_provider());
+#if defined(__linux__)
+    ASSERT_OK(run_hugepage_provider());
+    ASSERT_OK(run_memfd_provider());
+#endif
+    ASSERT_OK(run_provider_stats());
+    ASSERT_OK(run_typed_buffers());
+    ASSERT_OK(run_memory_resource());
+    ASSERT_OK(run_shm_bytes_writer());
+    ASSERT_OK(run_async_alloc());
+    ASSERT_OK(run_provider_maintenance());
+    ASSERT_OK(run_slab_thread_cache());
     ASSERT_OK(run_default_client_storage());
     ASSERT_OK(run_global_client_storage());
     ASSERT_OK(run_client_storage());
     ASSERT_OK(run_c_client());
+    ASSERT_OK(run_cached_client());
     ASSERT_OK(run_cleanup());
     return Z_OK;
 }
@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2024 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+// Built as C++20, see tests/CMakeLists.txt.
+
+#include <future>
+
+#include "zenoh.hxx"
+
+using namespace zenoh;
+
+#undef NDEBUG
+#include <assert.h>
+
+#ifdef ZENOHCXX_SHM_COROUTINES
+// A coroutine starting eagerly and destroying itself once done.
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Task alloc_from_provider(const ShmProvider& provider, size_t size, std::promise<size_t>& done) {
+    BufLayoutAllocResult result = co_await provider.alloc_gc_defrag_awaitable(size, AllocAlignment({4}));
+    done.set_value(std::holds_alternative<ZShmMut>(result) ? std::get<ZShmMut>(result).len() : 0);
+}
+
+Task alloc_from_layout(const AllocLayout& layout, std::promise<size_t>& done) {
+    BufAllocResult result = co_await layout.alloc_gc_defrag_awaitable();
+    done.set_value(std::holds_alternative<ZShmMut>(result) ? std::get<ZShmMut>(result).len() : 0);
+}
+
+void awaitable_alloc() {
+    CppShmProvider provider(100520, std::unique_ptr<CppShmProviderBackendThreadsafe>(
+                                        std::make_unique<TlsfShmProviderBackendThreadsafe>(64 * 1024)));
+
+    std::promise<size_t> provider_done;
+    alloc_from_provider(provider, 1024, provider_done);
+    assert(provider_done.get_future().get() == 1024);
+
+    AllocLayout layout(provider, 256, AllocAlignment({4}));
+    std::promise<size_t> layout_done;
+    alloc_from_layout(layout, layout_done);
+    assert(layout_done.get_future().get() == 256);
+
+    // too large for the provider, the coroutine is still resumed
+    std::promise<size_t> failed;
+    alloc_from_provider(provider, 1024 * 1024, failed);
+    assert(failed.get_future().get() == 0);
+}
+#endif
+
+int main(int, char**) {
+#ifdef ZENOHCXX_SHM_COROUTINES
+    awaitable_alloc();
+#endif
+    return 0;
+}